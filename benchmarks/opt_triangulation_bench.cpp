@@ -0,0 +1,244 @@
+//Benchmark of the methods over the instances of tests: every instance under every method, with fixed seeds and
+//repetitions. Every run is a child process (fork), so the wall time, the CPU time and the peak RSS are the ones
+//of the run alone. The report is written as CSV and as JSON, one row for every run.
+//Usage: opt_triangulation_bench [instance files or directories] [-methods local,sa,ant,auto,instance] [-reps N]
+//       [-seed S] [-match text] [-limit N] [-threads N] [-chains K] [-replicas R] [-csv file] [-json file]
+//Without instances it runs tests/challenge_instances and tests/common_instances. The methods take the parameters
+//of update_json_files.py, "instance" keeps the method and the parameters of the instance file.
+#include "../includes/utils/solver.h"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct Bench_run {
+    std_string instance, method, status;
+    int rep = 0;
+    unsigned int seed = 0;
+    double wall = 0.0, cpu = 0.0, energy = 0.0;
+    long peak_rss_kb = 0;
+    int init_obtuses = 0, final_obtuses = 0, num_steiners = 0;
+};
+
+//The method and the parameters of update_json_files.py
+bool set_method(value& jv, const std_string& method) {
+    if (method == "instance") return true;
+    object& obj = jv.as_object();
+    if (method == "local") {
+        obj["method"] = "local";
+        obj["parameters"] = {{"L", 150}, {"alpha", 2.4}, {"beta", 0.2}};
+        obj["delaunay"] = true;
+    }
+    else if (method == "sa") {
+        obj["method"] = "sa";
+        obj["parameters"] = {{"alpha", 2.4}, {"beta", 0.2}, {"L", 500}, {"batch_size", 6}};
+        obj["delaunay"] = true;
+    }
+    else if (method == "ant") {
+        obj["method"] = "ant";
+        obj["parameters"] = {{"alpha", 2.4}, {"beta", 0.2}, {"xi", 1.0}, {"psi", 2.0}, {"lambda", 0.2}, {"kappa", 10}, {"L", 150}};
+        obj["delaunay"] = true;
+    }
+    else if (method == "auto") {
+        obj["method"] = "auto";
+        obj["parameters"] = {{"alpha", 2.4}, {"beta", 0.2}, {"L", 800}, {"batch_size", 6}};
+        obj["delaunay"] = false;
+    }
+    else return false;
+    return true;
+}
+
+//The json files of a directory (sorted, the first limit of them that contain match), or the file itself
+vector<std_string> instance_files(const std_string& path, const std_string& match, int limit) {
+    vector<std_string> files;
+    if (!fs::is_directory(path)) {
+        files.push_back(path);
+        return files;
+    }
+    for (const auto& entry : fs::directory_iterator(path)) {
+        std_string name = entry.path().filename().string();
+        if (entry.path().extension() == ".json" && name.find(match) != std_string::npos) files.push_back(entry.path().string());
+    }
+    sort(files.begin(), files.end());
+    if (limit >= 0 && static_cast<int>(files.size()) > limit) files.resize(limit);
+    return files;
+}
+
+//One run in a child process. The child writes its counts in a pipe, its output goes to /dev/null
+void run_child(const value& instance, const Solve_options& options, Bench_run& run) {
+    int channel[2];
+    if (pipe(channel) != 0) {
+        run.status = "pipe failed";
+        return;
+    }
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        run.status = "fork failed";
+        return;
+    }
+    if (pid == 0) {
+        close(channel[0]);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) dup2(null_fd, STDOUT_FILENO);
+        int code = 0;
+        ostringstream counts;
+        try {
+            value jv = instance;
+            Solve_result result;
+            set_random_seed(run.seed);
+            if (solve_instance(jv, options, result)) {
+                counts<<result.init_obtuses<<" "<<result.final_obtuses<<" "<<result.num_steiners<<" "
+                      <<setprecision(17)<<result.energy<<endl;
+            }
+            else code = 2;
+        }
+        catch (const exception& error) {
+            cerr<<"Run failed: "<<error.what()<<endl;
+            code = 3;
+        }
+        std_string text = counts.str();
+        if (write(channel[1], text.data(), text.size()) != static_cast<ssize_t>(text.size())) code = 4;
+        close(channel[1]);
+        _exit(code);
+    }
+    close(channel[1]);
+    std_string text;
+    char buffer[256];
+    ssize_t size;
+    while ((size = read(channel[0], buffer, sizeof(buffer))) > 0) text.append(buffer, size);
+    close(channel[0]);
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    run.wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    run.cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+    //Kilobytes on Linux
+    run.peak_rss_kb = usage.ru_maxrss;
+    istringstream counts(text);
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+        counts>>run.init_obtuses>>run.final_obtuses>>run.num_steiners>>run.energy) {
+        run.status = "ok";
+    }
+    else if (WIFSIGNALED(status)) run.status = "signal " + to_string(WTERMSIG(status));
+    else run.status = "exit " + to_string(WEXITSTATUS(status));
+}
+
+void write_csv(const std_string& path, const vector<Bench_run>& runs) {
+    ofstream outFile(path);
+    if (!outFile) {
+        cerr<<"Error: Could not open "<<path<<" for writing!"<<endl;
+        return;
+    }
+    outFile<<"instance,method,rep,seed,wall_s,cpu_s,peak_rss_kb,init_obtuses,final_obtuses,steiners,energy,status"<<endl;
+    for (const Bench_run& run : runs) {
+        outFile<<run.instance<<","<<run.method<<","<<run.rep<<","<<run.seed<<","<<run.wall<<","<<run.cpu<<","
+               <<run.peak_rss_kb<<","<<run.init_obtuses<<","<<run.final_obtuses<<","<<run.num_steiners<<","
+               <<run.energy<<","<<run.status<<endl;
+    }
+}
+
+void write_json(const std_string& path, const vector<Bench_run>& runs) {
+    ofstream outFile(path);
+    if (!outFile) {
+        cerr<<"Error: Could not open "<<path<<" for writing!"<<endl;
+        return;
+    }
+    boost::json::array report;
+    for (const Bench_run& run : runs) {
+        report.push_back(object{{"instance", run.instance}, {"method", run.method}, {"rep", run.rep}, {"seed", run.seed},
+                                {"wall_s", run.wall}, {"cpu_s", run.cpu}, {"peak_rss_kb", run.peak_rss_kb},
+                                {"init_obtuses", run.init_obtuses}, {"final_obtuses", run.final_obtuses},
+                                {"steiners", run.num_steiners}, {"energy", run.energy}, {"status", run.status}});
+    }
+    outFile<<serialize(report)<<endl;
+}
+
+vector<std_string> split(const std_string& text, char separator) {
+    vector<std_string> parts;
+    std_string part;
+    istringstream stream(text);
+    while (getline(stream, part, separator)) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+int main(int argc, char* argv[]) {
+    vector<std_string> paths, methods = {"local", "sa", "ant", "auto"};
+    std_string match, csv_path = "opt_triangulation_bench.csv", json_path = "opt_triangulation_bench.json";
+    int reps = 1, limit = -1;
+    unsigned int seed = 1;
+    Solve_options options;
+    for (int i = 1; i < argc; ++i) {
+        std_string arg = argv[i];
+        if (arg == "-methods" && i + 1 < argc) methods = split(argv[++i], ',');
+        else if (arg == "-reps" && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (arg == "-seed" && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-match" && i + 1 < argc) match = argv[++i];
+        else if (arg == "-limit" && i + 1 < argc) limit = atoi(argv[++i]);
+        else if (arg == "-threads" && i + 1 < argc) options.num_threads = max(1, atoi(argv[++i]));
+        else if (arg == "-chains" && i + 1 < argc) options.num_chains = max(1, atoi(argv[++i]));
+        else if (arg == "-replicas" && i + 1 < argc) options.num_replicas = max(1, atoi(argv[++i]));
+        else if (arg == "-csv" && i + 1 < argc) csv_path = argv[++i];
+        else if (arg == "-json" && i + 1 < argc) json_path = argv[++i];
+        else if (!arg.empty() && arg[0] == '-') {
+            cerr<<"Unknown option "<<arg<<endl;
+            return 1;
+        }
+        else paths.push_back(arg);
+    }
+    if (paths.empty()) paths = {"tests/challenge_instances", "tests/common_instances"};
+    for (const std_string& method : methods) {
+        value probe = object{};
+        if (!set_method(probe, method)) {
+            cerr<<"Unknown method "<<method<<endl;
+            return 1;
+        }
+    }
+
+    vector<std_string> files;
+    for (const std_string& path : paths) {
+        for (const std_string& file : instance_files(path, match, limit)) files.push_back(file);
+    }
+    cout<<files.size()<<" instances, "<<methods.size()<<" methods, "<<reps<<" repetitions"<<endl;
+    cout<<left<<setw(48)<<"instance"<<setw(10)<<"method"<<right<<setw(5)<<"rep"<<setw(10)<<"wall s"<<setw(10)<<"cpu s"
+        <<setw(12)<<"rss KB"<<setw(10)<<"obtuses"<<setw(10)<<"steiners"<<setw(10)<<"energy"<<"  status"<<endl;
+
+    vector<Bench_run> runs;
+    for (const std_string& file : files) {
+        value jv;
+        read_json(file, jv);
+        if (!jv.is_object()) continue;
+        for (const std_string& method : methods) {
+            value instance = jv;
+            set_method(instance, method);
+            for (int rep = 0; rep < reps; ++rep) {
+                Bench_run run;
+                run.instance = fs::path(file).filename().string();
+                run.method = method;
+                run.rep = rep;
+                //The same seed for every instance and method, so the runs of a repetition compare
+                run.seed = seed + rep;
+                run_child(instance, options, run);
+                cout<<left<<setw(48)<<run.instance<<setw(10)<<run.method<<right<<setw(5)<<run.rep<<fixed<<setprecision(3)
+                    <<setw(10)<<run.wall<<setw(10)<<run.cpu<<setw(12)<<run.peak_rss_kb<<setw(10)<<run.final_obtuses
+                    <<setw(10)<<run.num_steiners<<setw(10)<<setprecision(2)<<run.energy<<"  "<<run.status<<endl;
+                cout.unsetf(ios::fixed);
+                runs.push_back(run);
+            }
+        }
+    }
+    write_csv(csv_path, runs);
+    write_json(json_path, runs);
+    cout<<"Report: "<<csv_path<<", "<<json_path<<endl;
+    return 0;
+}
@@ -0,0 +1,119 @@
+//Microbenchmark of the obtuse and flip predicates: the exact CGAL calls that the algorithms used before
+//(reference) against the filtered ones of filtered_predicates.h. Both run on the same triangles and the
+//results are compared, so the benchmark also checks that the filtered predicates agree.
+//Usage: predicates_bench [number of triangles] [seed]
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <CGAL/Polygon_2_algorithms.h>
+#include "../includes/utils/filtered_predicates.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Point_2 = K::Point_2;
+using Line_2 = K::Line_2;
+
+//The predicates as they were: three CGAL::angle calls
+bool reference_is_obtuse(const Point_2& a, const Point_2& b, const Point_2& c) {
+    return (CGAL::angle(a, b, c) == CGAL::OBTUSE ||
+            CGAL::angle(b, a, c) == CGAL::OBTUSE ||
+            CGAL::angle(a, c, b) == CGAL::OBTUSE);
+}
+
+//is_convex_2, four orientations and four obtuse tests
+bool reference_is_it_worth_flip(const Point_2& p1, const Point_2& p2, const Point_2& p3, const Point_2& p4) {
+    vector<Point_2> points = {p1, p2, p3, p4};
+    if (!CGAL::is_convex_2(points.begin(), points.end(), K())) return false;
+    int obtuse_before_cnt = reference_is_obtuse(p1, p2, p3) + reference_is_obtuse(p1, p3, p4);
+    int obtuse_after_cnt = reference_is_obtuse(p1, p2, p4) + reference_is_obtuse(p2, p3, p4);
+    if (CGAL::orientation(p1, p2, p3) == CGAL::COLLINEAR || CGAL::orientation(p1, p2, p4) == CGAL::COLLINEAR ||
+        CGAL::orientation(p1, p3, p4) == CGAL::COLLINEAR || CGAL::orientation(p2, p3, p4) == CGAL::COLLINEAR) {
+        return false;
+    }
+    return obtuse_after_cnt < obtuse_before_cnt;
+}
+
+bool filtered_is_it_worth_flip(const Point_2& p1, const Point_2& p2, const Point_2& p3, const Point_2& p4) {
+    if (!filtered_is_strictly_convex(p1, p2, p3, p4)) return false;
+    int obtuse_before_cnt = filtered_is_obtuse(p1, p2, p3) + filtered_is_obtuse(p1, p3, p4);
+    int obtuse_after_cnt = filtered_is_obtuse(p1, p2, p4) + filtered_is_obtuse(p2, p3, p4);
+    return obtuse_after_cnt < obtuse_before_cnt;
+}
+
+//Nanoseconds per call of test over the quadruples, the sum of the results goes to checksum
+double time_per_call(const vector<Point_2>& points, const function<bool(const Point_2*)>& test, long long& checksum) {
+    checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i + 4 <= points.size(); i += 4) checksum += test(&points[i]);
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, nano>(end - start).count() / (points.size() / 4);
+}
+
+void run(const string& name, const vector<Point_2>& points) {
+    struct Case { string predicate; function<bool(const Point_2*)> reference, filtered; };
+    vector<Case> cases = {
+        {"is_obtuse",
+         [](const Point_2* p) { return reference_is_obtuse(p[0], p[1], p[2]); },
+         [](const Point_2* p) { return filtered_is_obtuse(p[0], p[1], p[2]); }},
+        {"is_it_worth_flip",
+         [](const Point_2* p) { return reference_is_it_worth_flip(p[0], p[1], p[2], p[3]); },
+         [](const Point_2* p) { return filtered_is_it_worth_flip(p[0], p[1], p[2], p[3]); }},
+    };
+    for (const Case& c : cases) {
+        long long reference_sum = 0, filtered_sum = 0;
+        //Once untimed, so that both see the same cached exact values
+        time_per_call(points, c.reference, reference_sum);
+        double before = time_per_call(points, c.reference, reference_sum);
+        double after = time_per_call(points, c.filtered, filtered_sum);
+        cout<<left<<setw(12)<<name<<setw(18)<<c.predicate<<right<<fixed<<setprecision(1)
+            <<setw(12)<<before<<setw(12)<<after<<setw(9)<<setprecision(2)<<before / after<<"x"
+            <<(reference_sum == filtered_sum ? "" : "   MISMATCH")<<endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 200000;
+    mt19937 rng((argc > 2) ? strtoul(argv[2], nullptr, 10) : 1);
+    uniform_int_distribution<int> coordinate(0, 10000);
+
+    //Integer points, as the input of the instances
+    vector<Point_2> input;
+    for (size_t i = 0; i < 4 * n; ++i) input.emplace_back(coordinate(rng), coordinate(rng));
+
+    //Constructed points, as the Steiner points: midpoints, projections and centroids of the input
+    vector<Point_2> steiner;
+    for (size_t i = 0; i + 4 <= input.size(); i += 4) {
+        const Point_2* p = &input[i];
+        steiner.push_back(CGAL::midpoint(p[0], p[1]));
+        steiner.push_back(Line_2(p[1], p[2]).projection(p[0]));
+        steiner.push_back(CGAL::centroid(p[0], p[1], p[2]));
+        steiner.push_back(p[3]);
+    }
+
+    //Right angles (the projection of a vertex on the opposite line): every test needs the exact fallback
+    vector<Point_2> right;
+    for (size_t i = 0; i + 4 <= input.size(); i += 4) {
+        const Point_2* p = &input[i];
+        if (p[1] == p[2]) continue;
+        Point_2 foot = Line_2(p[1], p[2]).projection(p[0]);
+        right.push_back(p[0]);
+        right.push_back(foot);
+        right.push_back(p[1]);
+        right.push_back(p[2]);
+    }
+
+    cout<<"Triangles per workload: "<<n<<endl;
+    cout<<left<<setw(12)<<"workload"<<setw(18)<<"predicate"<<right<<setw(12)<<"ns before"<<setw(12)<<"ns after"
+        <<setw(10)<<"speedup"<<endl;
+    run("input", input);
+    run("steiner", steiner);
+    run("right", right);
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include "includes/utils/checkpoint.h"
+
+#include <cstdio>
+#include <unistd.h>
+
+using namespace boost::json;
+using namespace std;
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Custom_CDT = Custom_Constrained_Delaunay_triangulation_2<K>;
+using Point_2 = K::Point_2;
+using std_string = std::string;
+
+//The checkpoints of the instance of this thread
+struct Checkpoint_context {
+    std_string path, instance_uid;
+    double interval = 0.0;
+    std::chrono::steady_clock::time_point last;
+    bool loaded = false, resume_taken = false;
+    Checkpoint resume;
+};
+static thread_local Checkpoint_context context;
+
+void set_checkpoint_file(const std_string& path, double interval, bool resume, const std_string& instance_uid) {
+    context = Checkpoint_context();
+    context.path = path;
+    context.instance_uid = instance_uid;
+    context.interval = interval;
+    context.last = std::chrono::steady_clock::now();
+    if (path.empty() || !resume) return;
+    Checkpoint checkpoint;
+    if (!read_checkpoint(path, checkpoint)) {
+        cout<<"No checkpoint to resume in "<<path<<", starting from the beginning"<<endl;
+        return;
+    }
+    if (checkpoint.instance_uid != instance_uid) {
+        cerr<<"The checkpoint "<<path<<" is of the instance "<<checkpoint.instance_uid<<", not of "<<instance_uid<<endl;
+        return;
+    }
+    context.resume = checkpoint;
+    context.loaded = true;
+}
+
+const Checkpoint* loaded_checkpoint() {
+    return context.loaded ? &context.resume : nullptr;
+}
+
+bool take_resume_checkpoint(const std_string& engine, Checkpoint& checkpoint) {
+    if (!context.loaded || context.resume_taken || context.resume.engine != engine) return false;
+    context.resume_taken = true;
+    checkpoint = context.resume;
+    return true;
+}
+
+bool checkpoint_due() {
+    if (context.path.empty() || context.interval <= 0) return false;
+    return std::chrono::steady_clock::now() - context.last >= std::chrono::duration<double>(context.interval);
+}
+
+void save_checkpoint(const std_string& engine, const Custom_CDT& best_cdt, const Polygon& polygon, Checkpoint& state) {
+    if (context.path.empty()) return;
+    state.instance_uid = context.instance_uid;
+    state.engine = engine;
+    state.steiner_points = steiner_points_in_order(best_cdt);
+    state.polygon.assign(polygon.vertices_begin(), polygon.vertices_end());
+    if (!write_checkpoint(context.path, state)) cerr<<"Error: Could not write the checkpoint "<<context.path<<endl;
+    context.last = std::chrono::steady_clock::now();
+}
+
+//The steiner vertices by vertex id, the ids grow with the insertions
+vector<Point_2> steiner_points_in_order(const Custom_CDT& cdt) {
+    vector<pair<int, Point_2>> steiners;
+    for (auto vertex = cdt.finite_vertices_begin(); vertex != cdt.finite_vertices_end(); ++vertex) {
+        if (Custom_CDT::is_steiner_vertex(vertex)) steiners.emplace_back(Custom_CDT::vertex_id(vertex), vertex->point());
+    }
+    sort(steiners.begin(), steiners.end(), [](const pair<int, Point_2>& a, const pair<int, Point_2>& b) {
+        return a.first < b.first;
+    });
+    vector<Point_2> points;
+    for (const auto& steiner : steiners) points.push_back(steiner.second);
+    return points;
+}
+
+std_string rng_to_string(const std::mt19937& rng) {
+    ostringstream oss;
+    oss<<rng;
+    return oss.str();
+}
+
+void rng_from_string(const std_string& state, std::mt19937& rng) {
+    if (state.empty()) return;
+    istringstream iss(state);
+    iss>>rng;
+}
+
+//The coordinates are kept as exact rationals
+static std_string exact_to_string(const K::FT& coord) {
+    ostringstream oss;
+    oss<<CGAL::exact(coord);
+    return oss.str();
+}
+
+static void points_to_json(const vector<Point_2>& points, boost::json::array& xs, boost::json::array& ys) {
+    for (const Point_2& p : points) {
+        xs.push_back(boost::json::value(exact_to_string(p.x())));
+        ys.push_back(boost::json::value(exact_to_string(p.y())));
+    }
+}
+
+static vector<Point_2> points_from_json(const boost::json::array& xs, const boost::json::array& ys) {
+    if (xs.size() != ys.size()) throw logic_error("Different number of x and y coordinates in checkpoint");
+    vector<Point_2> points;
+    for (size_t i = 0; i < xs.size(); ++i) {
+        points.emplace_back(convert_from_string(xs[i].as_string().c_str()), convert_from_string(ys[i].as_string().c_str()));
+    }
+    return points;
+}
+
+bool write_checkpoint(const std_string& path, const Checkpoint& checkpoint) {
+    boost::json::array steiner_x, steiner_y, polygon_x, polygon_y, taf, delta_taf;
+    points_to_json(checkpoint.steiner_points, steiner_x, steiner_y);
+    points_to_json(checkpoint.polygon, polygon_x, polygon_y);
+    for (double pheromone : checkpoint.taf) taf.push_back(pheromone);
+    for (double pheromone : checkpoint.delta_taf) delta_taf.push_back(pheromone);
+    boost::json::object json{
+        {"content_type", "CG_SHOP_2025_Checkpoint"},
+        {"instance_uid", checkpoint.instance_uid},
+        {"engine", checkpoint.engine},
+        {"iteration", checkpoint.iteration},
+        {"temperature", checkpoint.temperature},
+        {"steiner_points_x", steiner_x},
+        {"steiner_points_y", steiner_y},
+        {"polygon_x", polygon_x},
+        {"polygon_y", polygon_y},
+        {"taf", taf},
+        {"delta_taf", delta_taf},
+        {"rng_state", checkpoint.rng_state}};
+    std_string text = serialize(json);
+
+    //Write the whole file under a temporary name and rename it over the old checkpoint, a crash leaves one of the two
+    std_string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "w");
+    if (!file) return false;
+    bool written = fwrite(text.data(), 1, text.size(), file) == text.size() && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (fclose(file) != 0) written = false;
+    if (!written || rename(temporary.c_str(), path.c_str()) != 0) {
+        remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool read_checkpoint(const std_string& path, Checkpoint& checkpoint) {
+    ifstream file(path);
+    if (!file) return false;
+    try {
+        std_string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        value parsed = parse(text);
+        const boost::json::object& json = parsed.as_object();
+        checkpoint.instance_uid = json.at("instance_uid").as_string().c_str();
+        checkpoint.engine = json.at("engine").as_string().c_str();
+        checkpoint.iteration = json.at("iteration").as_int64();
+        checkpoint.temperature = json.at("temperature").to_number<double>();
+        checkpoint.steiner_points = points_from_json(json.at("steiner_points_x").as_array(), json.at("steiner_points_y").as_array());
+        checkpoint.polygon = points_from_json(json.at("polygon_x").as_array(), json.at("polygon_y").as_array());
+        checkpoint.taf.clear();
+        checkpoint.delta_taf.clear();
+        for (const auto& pheromone : json.at("taf").as_array()) checkpoint.taf.push_back(pheromone.to_number<double>());
+        for (const auto& pheromone : json.at("delta_taf").as_array()) checkpoint.delta_taf.push_back(pheromone.to_number<double>());
+        checkpoint.rng_state = json.at("rng_state").as_string().c_str();
+    }
+    catch (const exception& error) {
+        cerr<<"Error reading the checkpoint "<<path<<": "<<error.what()<<endl;
+        return false;
+    }
+    return true;
+}
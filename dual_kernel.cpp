@@ -0,0 +1,129 @@
+#include "includes/utils/functions.h"
+
+using namespace std;
+using Inexact_face = Inexact_CDT::Face_handle;
+using Inexact_line = IK::Line_2;
+
+//The mode of this process, the workers of the searches read it
+static std::atomic<bool> dual_kernel(false);
+
+void set_dual_kernel(bool enabled) {
+    dual_kernel = enabled;
+}
+
+bool dual_kernel_enabled() {
+    return dual_kernel;
+}
+
+Inexact_point to_inexact(const Point_2& p) {
+    return Inexact_point(CGAL::to_double(p.x()), CGAL::to_double(p.y()));
+}
+
+static void mirror_polygon(const Polygon& polygon, Inexact_mirror& mirror) {
+    mirror.polygon.clear();
+    for (auto vertex = polygon.vertices_begin(); vertex != polygon.vertices_end(); ++vertex) {
+        mirror.polygon.push_back(to_inexact(*vertex));
+    }
+    mirror.polygon.build_region_index();
+}
+
+void build_mirror(const Custom_CDT& cdt, const Polygon& polygon, Inexact_mirror& mirror) {
+    mirror_polygon(polygon, mirror);
+    mirror.cdt.copy_from(cdt, [](const Point_2& p) { return to_inexact(p); }, mirror.polygon);
+    mirror.rebuilds++;
+}
+
+Mirror_face mirror_face_of(const Face_handle& face) {
+    Inexact_point p0 = to_inexact(face->vertex(0)->point());
+    Inexact_point p1 = to_inexact(face->vertex(1)->point());
+    Inexact_point p2 = to_inexact(face->vertex(2)->point());
+    return {CGAL::centroid(p0, p1, p2), Custom_CDT::face_key(face)};
+}
+
+//The flip rule of start_the_flips (is_it_worth_flip) on doubles
+static bool inexact_worth_flip(const Inexact_point& p1, const Inexact_point& p2, const Inexact_point& p3, const Inexact_point& p4) {
+    if (!filtered_is_strictly_convex(p1, p2, p3, p4)) return false;
+    int obtuse_before = filtered_is_obtuse(p1, p2, p3) + filtered_is_obtuse(p1, p3, p4);
+    int obtuse_after = filtered_is_obtuse(p1, p2, p4) + filtered_is_obtuse(p2, p3, p4);
+    return obtuse_after < obtuse_before;
+}
+
+static bool inside_mirror_region(const Inexact_mirror& mirror, const Inexact_point& p) {
+    return mirror.polygon.bounded_side(p) != CGAL::ON_UNBOUNDED_SIDE;
+}
+
+//find_steiner_point on the mirror face, the same tests in doubles
+static bool find_inexact_steiner(const Inexact_mirror& mirror, int method, const Inexact_face& face, Inexact_point& steiner) {
+    const Inexact_point& p1 = face->vertex(0)->point();
+    const Inexact_point& p2 = face->vertex(1)->point();
+    const Inexact_point& p3 = face->vertex(2)->point();
+    const auto& record = Inexact_CDT::face_record(face);
+    switch (method) {
+        case 0: {
+            int obtuse = record.obtuse_vertex;
+            if (obtuse < 0 || mirror.cdt.is_constrained(Inexact_CDT::Edge(face, obtuse))) return false;
+            steiner = CGAL::circumcenter(p1, p2, p3);
+            if (!inside_mirror_region(mirror, steiner)) return false;
+            bool in_neighbor = false;
+            for (int i = 0; i < 3 && !in_neighbor; ++i) {
+                Inexact_face neighbor = face->neighbor(i);
+                if (mirror.cdt.is_infinite(neighbor)) continue;
+                CGAL::Triangle_2<IK> triangle(neighbor->vertex(0)->point(), neighbor->vertex(1)->point(), neighbor->vertex(2)->point());
+                in_neighbor = triangle.bounded_side(steiner) != CGAL::ON_UNBOUNDED_SIDE;
+            }
+            vector<Inexact_point> quadrilateral = {p1, p2, p3, steiner};
+            if (!in_neighbor || !CGAL::is_convex_2(quadrilateral.begin(), quadrilateral.end(), IK())) return false;
+            return Inexact_CDT::is_in_domain(mirror.cdt.locate(steiner));
+        }
+        case 1: {
+            int opposite = record.longest_edge;
+            steiner = CGAL::midpoint(face->vertex((opposite + 1) % 3)->point(), face->vertex((opposite + 2) % 3)->point());
+            return inside_mirror_region(mirror, steiner);
+        }
+        case 2: {
+            int obtuse = record.obtuse_vertex;
+            if (obtuse < 0) return false;
+            Inexact_line line(face->vertex(obtuse == 0 ? 1 : 0)->point(), face->vertex(obtuse == 2 ? 1 : 2)->point());
+            steiner = line.projection(face->vertex(obtuse)->point());
+            return inside_mirror_region(mirror, steiner);
+        }
+        case 4:
+            steiner = CGAL::centroid(p1, p2, p3);
+            return true;
+        default: return false;
+    }
+}
+
+bool mirror_evaluate(const Inexact_mirror& mirror, int method, const Mirror_face& face, Mirror_score& score) {
+    if (method == 3 || mirror.cdt.dimension() < 2) return false;
+    Inexact_face mirror_face = mirror.cdt.locate(face.inside);
+    if (mirror.cdt.is_infinite(mirror_face) || Inexact_CDT::face_key(mirror_face) != face.key) return false;
+    score = Mirror_score();
+    Inexact_point steiner;
+    score.found = find_inexact_steiner(mirror, method, mirror_face, steiner);
+    if (!score.found) return true;
+    auto delta = mirror.cdt.evaluate_insertion(steiner, [](const Inexact_point& p1, const Inexact_point& p2,
+                                                           const Inexact_point& p3, const Inexact_point& p4) {
+        return inexact_worth_flip(p1, p2, p3, p4);
+    }, mirror_face);
+    score.valid = delta.valid;
+    score.obtuse_delta = delta.valid ? delta.obtuse_delta : 0;
+    return true;
+}
+
+void mirror_insert(Inexact_mirror& mirror, const Custom_CDT& cdt, const Polygon& polygon, const Point_2& steiner_point) {
+    Inexact_CDT::Vertex_handle vertex = mirror.cdt.insert_no_flip(to_inexact(steiner_point));
+    mirror.cdt.flip_edges(vertex, [](const Inexact_point& p1, const Inexact_point& p2, const Inexact_point& p3, const Inexact_point& p4) {
+        return inexact_worth_flip(p1, p2, p3, p4);
+    });
+    mirror.replays++;
+    //A steiner on the boundary split an edge of the region
+    if (mirror.polygon.size() != polygon.size()) mirror_polygon(polygon, mirror);
+    //Reconcile: the rounding gave another triangulation, or the ids went apart (then the face keys differ and
+    //mirror_evaluate could answer no face)
+    if (mirror.cdt.number_of_vertices() != cdt.number_of_vertices() ||
+        mirror.cdt.number_of_obtuse_faces() != cdt.number_of_obtuse_faces() ||
+        mirror.cdt.vertex_id_bound() != cdt.vertex_id_bound()) {
+        build_mirror(cdt, polygon, mirror);
+    }
+}
@@ -1,12 +1,12 @@
 #include "includes/utils/functions.h"
-#include "includes/utils/extra_graphics.h"
+#include "includes/utils/checkpoint.h"
 
 using namespace boost::json;
 using namespace std;
 using K = CGAL::Exact_predicates_exact_constructions_kernel;
 using CDT = CGAL::Constrained_Delaunay_triangulation_2<K>;
 using Point = CDT::Point;
-typedef CGAL::Polygon_2<K> Polygon;
+typedef Custom_Polygon_2<K> Polygon;
 using Custom_CDT = Custom_Constrained_Delaunay_triangulation_2<K>;
 using Point_2 = K::Point_2;
 using Line_2 = K::Line_2;
@@ -17,19 +17,77 @@ using std_string = std::string;
 
 //Is obtuse face
 bool is_obtuse(const Face_handle& face) {
-    Point_2 a = face->vertex(0)->point();
-    Point_2 b = face->vertex(1)->point();
-    Point_2 c = face->vertex(2)->point();
-    return (CGAL::angle(a, b, c) == CGAL::OBTUSE || 
-            CGAL::angle(b, a, c) == CGAL::OBTUSE || 
-            CGAL::angle(a, c, b) == CGAL::OBTUSE);
+    return Custom_CDT::face_record(face).obtuse_vertex >= 0;
 }
 
 //Is obtuse 3 points (1 face)
 bool is_obtuse2(const Point_2& a, const Point_2& b, const Point_2& c) {
-    return (CGAL::angle(a, b, c) == CGAL::OBTUSE || 
-            CGAL::angle(b, a, c) == CGAL::OBTUSE || 
-            CGAL::angle(a, c, b) == CGAL::OBTUSE);
+    return filtered_is_obtuse(a, b, c);
+}
+
+//The seeds of the random generators: from std::random_device, or after set_random_seed(seed) from one generator
+//with that seed, so that a run on one thread can be repeated
+static std::mutex seed_mutex;
+static std::unique_ptr<std::mt19937> seed_generator;
+
+void set_random_seed(unsigned int seed) {
+    std::lock_guard<std::mutex> lock(seed_mutex);
+    seed_generator.reset(new std::mt19937(seed));
+}
+
+unsigned int next_random_seed() {
+    std::lock_guard<std::mutex> lock(seed_mutex);
+    if (!seed_generator) return std::random_device{}();
+    return (*seed_generator)();
+}
+
+//Cooperative stop of the searches: a deadline of the whole run, a deadline of the instance that this thread solves
+//and the stop of SIGINT/SIGTERM. The search loops poll search_should_stop() and return their best triangulation
+static std::atomic<bool> stop_requested(false);
+static std::atomic<std::chrono::steady_clock::rep> run_deadline(std::chrono::steady_clock::time_point::max().time_since_epoch().count());
+static thread_local std::chrono::steady_clock::time_point thread_deadline = std::chrono::steady_clock::time_point::max();
+
+static std::chrono::steady_clock::time_point deadline_after(double seconds) {
+    if (seconds <= 0) return std::chrono::steady_clock::time_point::max();
+    return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(seconds));
+}
+
+void set_run_time_limit(double seconds) {
+    run_deadline = deadline_after(seconds).time_since_epoch().count();
+}
+
+void set_instance_time_limit(double seconds) {
+    thread_deadline = deadline_after(seconds);
+}
+
+std::chrono::steady_clock::time_point instance_deadline() {
+    return thread_deadline;
+}
+
+//The workers of an engine take the deadline of the thread that started them
+void set_instance_deadline(std::chrono::steady_clock::time_point deadline) {
+    thread_deadline = deadline;
+}
+
+bool run_should_stop() {
+    if (stop_requested.load(std::memory_order_relaxed)) return true;
+    return std::chrono::steady_clock::now().time_since_epoch().count() >= run_deadline.load(std::memory_order_relaxed);
+}
+
+bool search_should_stop() {
+    return run_should_stop() || std::chrono::steady_clock::now() >= thread_deadline;
+}
+
+//Only an atomic store, safe in a signal handler. A second signal terminates the program
+static void stop_signal_handler(int signal_number) {
+    stop_requested.store(true);
+    std::signal(signal_number, SIG_DFL);
+}
+
+void install_stop_signals() {
+    std::signal(SIGINT, stop_signal_handler);
+    std::signal(SIGTERM, stop_signal_handler);
 }
 
 //Read JSON file
@@ -43,14 +101,13 @@ void read_json(const std_string& filename, value& jv) {
     jv = parse(json_str);
 }
 
-//Just count the number of obtuses triangles in a cdt
-int count_obtuse_triangles(CDT& cdt, const Polygon& polygon) {
+//Number of obtuse triangles inside the region. The Custom CDT keeps a running count, updated on every
+//insertion and flip, so this is O(1) once set_region() was called. Otherwise scan all the faces.
+int count_obtuse_triangles(const Custom_CDT& cdt, const Polygon& polygon) {
+    if (cdt.has_region()) return cdt.number_of_obtuse_faces();
     int obtuse_count = 0;
     for (auto face = cdt.finite_faces_begin(); face != cdt.finite_faces_end(); ++face) {
-        Point_2 p1 = face->vertex(0)->point();
-        Point_2 p2 = face->vertex(1)->point();
-        Point_2 p3 = face->vertex(2)->point();
-        if (is_obtuse(face) && is_face_inside_region(face, polygon)) obtuse_count++;
+        if (is_obtuse(face) && is_face_inside_region(face)) obtuse_count++;
     }
     return obtuse_count;
 }
@@ -66,33 +123,21 @@ bool is_convex(const Point_2& p1, const Point_2& p2, const Point_2& p3, const Po
 
 //Return true if approves the flip
 bool is_it_worth_flip(const Point_2& p1, const Point_2& p2, const Point_2& p3, const Point_2& p4){
-    //Check if the quadrilateral (p2, p4, p3, p1) is convex
-    if (is_convex(p1, p2, p3, p4)) {
-            //Count obtuse angles before the flip
-            int obtuse_before_cnt = 0;
-            if(is_obtuse2(p1, p2, p3)) obtuse_before_cnt++;
-            if(is_obtuse2(p1, p3, p4)) obtuse_before_cnt++;
-
-            //Count obtuse angles after the potential flip
-            int obtuse_after_cnt = 0;
-            if(is_obtuse2(p1, p2, p4)) obtuse_after_cnt++;
-            if(is_obtuse2(p2, p3, p4)) obtuse_after_cnt++;
-
-            //Check collinearity of all possible triplets among p1, p2, p3, p4
-            if (CGAL::orientation(p1, p2, p3) == CGAL::COLLINEAR ||
-                CGAL::orientation(p1, p2, p4) == CGAL::COLLINEAR ||
-                CGAL::orientation(p1, p3, p4) == CGAL::COLLINEAR ||
-                CGAL::orientation(p2, p3, p4) == CGAL::COLLINEAR) {
-                //Skip the flip if any three points are collinear
-                return false;
-            }
+    //The quadrilateral (p1, p2, p3, p4) must be convex and skip the flip if any three points are collinear
+    if (!filtered_is_strictly_convex(p1, p2, p3, p4)) return false;
 
-            //If its worth flipping, do it!
-            if(obtuse_after_cnt < obtuse_before_cnt) return true;
-            else return false;
-    }
-    //Case quadrilateral is not convex
-    return false;      
+    //Count obtuse angles before the flip
+    int obtuse_before_cnt = 0;
+    if(is_obtuse2(p1, p2, p3)) obtuse_before_cnt++;
+    if(is_obtuse2(p1, p3, p4)) obtuse_before_cnt++;
+
+    //Count obtuse angles after the potential flip
+    int obtuse_after_cnt = 0;
+    if(is_obtuse2(p1, p2, p4)) obtuse_after_cnt++;
+    if(is_obtuse2(p2, p3, p4)) obtuse_after_cnt++;
+
+    //If its worth flipping, do it!
+    return obtuse_after_cnt < obtuse_before_cnt;
 }
 
 
@@ -118,27 +163,23 @@ Point_2 compute_centroid(const vector<Point_2>& points) {
 
 //Projection case
 void insert_projection(Custom_CDT& custom_cdt, const Face_handle& face, Polygon& polygon, Point_2& in_projection, Segment_2& opposide_edge){
-    
-    Point_2 p1 = face->vertex(0)->point();
-    Point_2 p2 = face->vertex(1)->point();
-    Point_2 p3 = face->vertex(2)->point();
-    Point_2 opposite1, opposite2;
-
-    Point_2 obtuse_angle_vertex = find_obtuse_vertex(p1, p2, p3);
-    //Find the obtuse point, and the 2 opposites
-    if (obtuse_angle_vertex == p1) {
-        opposite1 = p2;
-        opposite2 = p3;
-    } else if (obtuse_angle_vertex == p2) {
-        opposite1 = p1;
-        opposite2 = p3;
-    } else if (obtuse_angle_vertex == p3){
-        opposite1 = p1;
-        opposite2 = p2;
-    }
-    else{
-        cout<<"There is no obtuse angle"<<endl;
+    //standard check
+    if(find_projection(face, polygon, in_projection, opposide_edge)){
+        start_the_flips(custom_cdt, polygon, custom_cdt.insert_no_flip(in_projection));
+    }
+    else {
+        cout<<"PROJECTION DIDN'T INSERTED"<<endl;
+        cout<<"projected_point.x: "<<in_projection.x()<<" projected_point.y: "<<in_projection.y()<<endl;
     }
+}
+
+//Projection steiner point and its opposite edge, return true if it is inside of the region
+bool find_projection(const Face_handle& face, const Polygon& polygon, Point_2& in_projection, Segment_2& opposide_edge){
+    //Find the obtuse point, and the 2 opposites (in the order of the face)
+    int obtuse_index = find_obtuse_vertex_index(face);
+    Point_2 obtuse_angle_vertex = face->vertex(obtuse_index)->point();
+    Point_2 opposite1 = face->vertex(obtuse_index == 0 ? 1 : 0)->point();
+    Point_2 opposite2 = face->vertex(obtuse_index == 2 ? 1 : 2)->point();
     
     //Take the projection Steiner point
     Line_2 line(opposite1, opposite2);
@@ -147,34 +188,34 @@ void insert_projection(Custom_CDT& custom_cdt, const Face_handle& face, Polygon&
     in_projection = projected_point;
     //And the opposide edge of the projected_point
     opposide_edge = Segment_2(opposite1, opposite2);
-    bool insert_projection = is_point_inside_region(projected_point, polygon);
-    int obtuses_before = count_obtuse_triangles(custom_cdt, polygon);
-
-    //standard check
-    if(insert_projection){
-        custom_cdt.insert_no_flip(projected_point);
-        start_the_flips(custom_cdt, polygon);
-    }
-    else {
-        cout<<"PROJECTION DIDN'T INSERTED"<<endl;
-        cout<<"projected_point.x: "<<projected_point.x()<<" projected_point.y: "<<projected_point.y()<<endl;
-    }
+    return is_point_inside_region(projected_point, polygon);
 }
 
 //Midpoint Insertion:
 //Finds the longest edge of the obtuse triangle and calculates its midpoint.
 void insert_midpoint(Custom_CDT& custom_cdt, const Face_handle& face, Polygon& polygon, Point_2& in_midpoint, Segment_2& longest_edge) {
-    longest_edge = find_longest_edge(face);
-    Point_2 midpoint = CGAL::midpoint(longest_edge.source(), longest_edge.target());
-    in_midpoint = midpoint;
-
-    if (is_point_inside_region(midpoint, polygon)) {
-        custom_cdt.insert_no_flip(midpoint);
-        start_the_flips(custom_cdt, polygon);
+    if (find_midpoint(face, polygon, in_midpoint, longest_edge)) {
+        start_the_flips(custom_cdt, polygon, custom_cdt.insert_no_flip(in_midpoint));
     }  
 }
 
+//Midpoint of the longest edge, return true if it is inside of the region
+bool find_midpoint(const Face_handle& face, const Polygon& polygon, Point_2& in_midpoint, Segment_2& longest_edge) {
+    longest_edge = find_longest_edge(face);
+    in_midpoint = CGAL::midpoint(longest_edge.source(), longest_edge.target());
+    return is_point_inside_region(in_midpoint, polygon);
+}
+
 bool insert_adjacent_steiner(Custom_CDT& custom_cdt, const Face_handle& face1, const Polygon& polygon, Point_2& adjacent_steiner) {
+    if(find_adjacent_steiner(custom_cdt, face1, polygon, adjacent_steiner)){
+        start_the_flips(custom_cdt, polygon, custom_cdt.insert_no_flip(adjacent_steiner));
+        return true;
+    }
+    return false;
+}
+
+//Centroid of the obtuse neighbors of face1, return true if they form a convex polygon (and face1 has obtuse neighbors)
+bool find_adjacent_steiner(const Custom_CDT& custom_cdt, const Face_handle& face1, const Polygon& polygon, Point_2& adjacent_steiner) {
     //Before calling insert_adjacent_steiner, we know that the face1 is obtuse face
     if (!has_obtuse_neighbors(custom_cdt, face1, polygon)) return false;
     set<Point_2> unique_points;        //Collect all unique vertices of obtuse neighbors
@@ -196,19 +237,15 @@ bool insert_adjacent_steiner(Custom_CDT& custom_cdt, const Face_handle& face1, c
         face_queue.pop();
 
         //Check if the current face is inside the polygon
-        if (!is_face_inside_region(curent_face, polygon)) continue;
+        if (!is_face_inside_region(curent_face)) continue;
         
         //For every edge of the curent face, find obtuse neighbors and insert them into face_queue
         for (int i = 0; i < 3; ++i) {
             Face_handle neighbor = curent_face->neighbor(i);
 
-            //Get one edge of the curent_face
-            Point_2 p1 = curent_face->vertex((i + 1) % 3)->point();
-            Point_2 p2 = curent_face->vertex((i + 2) % 3)->point();
-
             //Skip already visited faces or unsuitable neighbors
             if (visited_faces.count(neighbor) > 0 || custom_cdt.is_infinite(neighbor) || 
-                !is_obtuse(neighbor) || custom_cdt.is_constrained(make_pair(curent_face, i)) || is_edge_on_boundary(p1, p2, polygon)) {
+                !is_obtuse(neighbor) || custom_cdt.is_constrained(make_pair(curent_face, i)) || is_edge_on_boundary(custom_cdt, curent_face, i)) {
                 continue;
             }
 
@@ -238,17 +275,13 @@ bool insert_adjacent_steiner(Custom_CDT& custom_cdt, const Face_handle& face1, c
         adjacent_steiner = CGAL::centroid(v0, v1, v2);
     }
     //Check if the polygon is convex
-    if(is_polygon_convex(unique_points)){
-        custom_cdt.insert_no_flip(adjacent_steiner);
-        start_the_flips(custom_cdt, polygon);
-        return true;
-    }
-    return false;
-    
+    return is_polygon_convex(unique_points);
 }
 
-//Adhjacent steiner method only for local search
-void insert_adjacent_steiner_local_search(Custom_CDT& custom_cdt, const Face_handle& face1, const Polygon& polygon, Point_2& adjacent_steiner) {
+//Adhjacent steiner method only for local search. With snap (a commit) every candidate is snapped before it is
+//simulated, so the inserted points are the scored ones
+void insert_adjacent_steiner_local_search(Custom_CDT& custom_cdt, const Face_handle& face1, const Polygon& polygon, Point_2& adjacent_steiner,
+                                          bool snap) {
     set<Point_2> unique_points;
     unsigned int initial_obtuse_count = count_obtuse_triangles(custom_cdt, polygon);
     unsigned int best_obtuse_count = initial_obtuse_count;
@@ -269,12 +302,15 @@ void insert_adjacent_steiner_local_search(Custom_CDT& custom_cdt, const Face_han
         unique_points.insert(face1->vertex(i)->point());
     }
 
+    //The candidates in BFS order: the centroid of the collected points and if they form a convex polygon.
+    //The BFS only reads the triangulation, so collect them first and insert afterwards.
+    vector<pair<Point_2, bool>> candidates;
     while (!face_queue.empty()) {
         Face_handle curent_face = face_queue.front();
         face_queue.pop();
         
         //Check if the curent face is inside the region boundary
-        if (!is_face_inside_region(curent_face, polygon))  continue;
+        if (!is_face_inside_region(curent_face))  continue;
 
         //Traverse the neighbors of the curent face
         for (int i = 0; i < 3; ++i) {
@@ -287,7 +323,7 @@ void insert_adjacent_steiner_local_search(Custom_CDT& custom_cdt, const Face_han
             }
             //We have just an iterator and this iterator may go out of bounds
             //because he doesn't have the supervision of for loop
-            if(!is_face_inside_region(neighbor, polygon)) continue;
+            if(!is_face_inside_region(neighbor)) continue;
             
             //Add the vertices of the curent face to the unique points
             for (int i = 0; i < 3; ++i) {
@@ -295,34 +331,143 @@ void insert_adjacent_steiner_local_search(Custom_CDT& custom_cdt, const Face_han
             }
             //Compute the centroid of all collected points as a Steiner candidate
             vector<Point_2> polygon_points(unique_points.begin(), unique_points.end());
-            Point_2 curent_steiner_point = compute_centroid(polygon_points);
+            candidates.emplace_back(compute_centroid(polygon_points), is_polygon_convex(unique_points));
 
-            //Simulate inserting this Steiner point in a temporary CDT
-            Custom_CDT simulate_cdt = custom_cdt;
-            simulate_cdt.insert_no_flip(curent_steiner_point);
-            start_the_flips(simulate_cdt, polygon);
-            unsigned int simulated_obtuse_count = count_obtuse_triangles(simulate_cdt, polygon);
-        
-            //Change the best_steiner_point and update the best_obtuse_count if worth it
-            if((simulated_obtuse_count < best_obtuse_count) && is_polygon_convex(unique_points)){
-                //Update best_obtuse_count, best_steiner_point, adjacent_steiner
-                best_obtuse_count = simulated_obtuse_count;
-                best_steiner_point = curent_steiner_point;
-                adjacent_steiner = best_steiner_point;
-                custom_cdt.insert_no_flip(best_steiner_point);
-                start_the_flips(custom_cdt, polygon);
-            }
             //Mark the neighbor as visited and add it to the queue
             visited_faces.insert(neighbor);
             face_queue.push(neighbor);
         }
     }
+
+    for (const auto& candidate : candidates) {
+        Point_2 curent_steiner_point = candidate.first;
+        if (snap) snap_steiner_point(custom_cdt, polygon, curent_steiner_point);
+        //Simulate inserting this Steiner point in a transaction and roll it back
+        custom_cdt.begin_transaction();
+        start_the_flips(custom_cdt, polygon, custom_cdt.insert_no_flip(curent_steiner_point));
+        unsigned int simulated_obtuse_count = count_obtuse_triangles(custom_cdt, polygon);
+        custom_cdt.rollback_transaction();
+
+        //Change the best_steiner_point and update the best_obtuse_count if worth it
+        if((simulated_obtuse_count < best_obtuse_count) && candidate.second){
+            //Update best_obtuse_count, best_steiner_point, adjacent_steiner
+            best_obtuse_count = simulated_obtuse_count;
+            best_steiner_point = curent_steiner_point;
+            adjacent_steiner = best_steiner_point;
+            start_the_flips(custom_cdt, polygon, custom_cdt.insert_no_flip(best_steiner_point));
+        }
+    }
+}
+
+//Insert the steiner point of a method the local search way: 0 circumcenter, 1 midpoint, 2 projection,
+//3 adjacent, 4 centroid. snap is set by the commits, the simulations insert the points as they are
+void insert_local_search_steiner(Custom_CDT& custom_cdt, int method, const Face_handle& face, Polygon& polygon,
+                                Point_2& steiner_point, Segment_2& longest_edge, Segment_2& opposide_edge, bool snap){
+    if (snap && method == 3) {
+        insert_adjacent_steiner_local_search(custom_cdt, face, polygon, steiner_point, true);
+        return;
+    }
+    if (snap) {
+        if (!find_steiner_point(custom_cdt, method, face, polygon, steiner_point, longest_edge, opposide_edge)) return;
+        snap_steiner_point(custom_cdt, polygon, steiner_point);
+        start_the_flips(custom_cdt, polygon, custom_cdt.insert_no_flip(steiner_point));
+        return;
+    }
+    switch(method){
+        case 0: insert_circumcenter(custom_cdt, face, polygon, steiner_point); break;
+        case 1: insert_midpoint(custom_cdt, face, polygon, steiner_point, longest_edge); break;
+        case 2: insert_projection(custom_cdt, face, polygon, steiner_point, opposide_edge); break;
+        case 3: insert_adjacent_steiner_local_search(custom_cdt, face, polygon, steiner_point); break;
+        case 4: insert_centroid(custom_cdt, face, polygon, steiner_point); break;
+        default: break;
+    }
+}
+
+//Number of obtuse faces after the steiner of a method (local search way) on face. The cdt is given back
+//unchanged: the single point methods are scored with evaluate_steiner, the adjacent one in a transaction.
+unsigned int score_local_search_steiner(Custom_CDT& custom_cdt, int method, const Face_handle& face, Polygon& polygon){
+    Point_2 steiner_point;
+    Segment_2 longest_edge, opposide_edge;
+    unsigned int obtuses_now = count_obtuse_triangles(custom_cdt, polygon);
+    //The adjacent method of local search inserts several points, simulate it in a transaction
+    if (method == 3) {
+        custom_cdt.begin_transaction();
+        insert_local_search_steiner(custom_cdt, method, face, polygon, steiner_point, longest_edge, opposide_edge);
+        unsigned int obtuses_after = count_obtuse_triangles(custom_cdt, polygon);
+        custom_cdt.rollback_transaction();
+        return obtuses_after;
+    }
+    if (!find_steiner_point(custom_cdt, method, face, polygon, steiner_point, longest_edge, opposide_edge)) return obtuses_now;
+    Insertion_delta delta = evaluate_steiner(custom_cdt, polygon, steiner_point);
+    return delta.valid ? obtuses_now + delta.obtuse_delta : obtuses_now;
+}
+
+//Parallel round of local search: every method on every face of obtuse_faces (faces of custom_cdt) on num_threads
+//workers. Every worker copies custom_cdt into its clone and takes the tasks t, t + num_threads, ..., so the scores
+//do not depend on the scheduling. The reduction keeps the first (face, method) with the minimum score.
+//With a mirror (dual kernel mode) every worker scores on its own copy of it, and copies custom_cdt only for the
+//tasks that the mirror cannot answer
+void best_local_search_move(const Custom_CDT& custom_cdt, const Polygon& polygon, const vector<Face_handle>& obtuse_faces,
+                            int num_threads, vector<Custom_CDT>& clones, int& best_face, int& best_method,
+                            unsigned int& best_obtuses, const Inexact_mirror* mirror){
+    //The workers find the faces in their clone from the centroid (strictly inside of the face)
+    vector<Point_2> centroids;
+    for (const Face_handle& face : obtuse_faces) {
+        centroids.push_back(CGAL::centroid(face->vertex(0)->point(), face->vertex(1)->point(), face->vertex(2)->point()));
+    }
+    vector<Mirror_face> mirror_faces;
+    if (mirror) {
+        for (const Face_handle& face : obtuse_faces) mirror_faces.push_back(mirror_face_of(face));
+    }
+    unsigned int obtuses_now = count_obtuse_triangles(custom_cdt, polygon);
+    vector<unsigned int> scores(obtuse_faces.size() * NUM_LOCAL_SEARCH_METHODS);
+    vector<exception_ptr> errors(num_threads);
+    vector<thread> workers;
+    clones.resize(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        workers.emplace_back([&, t]() {
+            try {
+                Inexact_mirror worker_mirror;
+                if (mirror) worker_mirror = *mirror;
+                bool cloned = false;
+                Polygon worker_polygon = polygon;
+                for (size_t task = t; task < scores.size(); task += num_threads) {
+                    Mirror_score score;
+                    if (mirror && mirror_evaluate(worker_mirror, task % NUM_LOCAL_SEARCH_METHODS, 
+                                                  mirror_faces[task / NUM_LOCAL_SEARCH_METHODS], score)) {
+                        scores[task] = obtuses_now + score.obtuse_delta;
+                        continue;
+                    }
+                    if (!cloned) {
+                        clones[t] = custom_cdt;
+                        cloned = true;
+                    }
+                    Face_handle face = clones[t].locate(centroids[task / NUM_LOCAL_SEARCH_METHODS]);
+                    scores[task] = score_local_search_steiner(clones[t], task % NUM_LOCAL_SEARCH_METHODS, face, worker_polygon);
+                }
+            }
+            catch (...) {
+                errors[t] = current_exception();
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+    for (const exception_ptr& error : errors) {
+        if (error) rethrow_exception(error);
+    }
+    best_face = best_method = -1;
+    for (size_t task = 0; task < scores.size(); ++task) {
+        if (best_face >= 0 && scores[task] >= best_obtuses) continue;
+        best_face = task / NUM_LOCAL_SEARCH_METHODS;
+        best_method = task % NUM_LOCAL_SEARCH_METHODS;
+        best_obtuses = scores[task];
+    }
 }
 
 //The local Search method
 void local_search(Custom_CDT& custom_cdt, Polygon& polygon, int& L, const std_string& name_of_instance, 
                 bool& in_randomization, const double& alpha, const double& beta, vector<int> subset, std_string category,
-                const bool& run_auto_method){
+                const bool& run_auto_method, const int& num_threads){
     vector<int> count_steiners(6, 0);
     vector<Point_2> random_steiners;
     Point_2 temp_random_steiner;
@@ -333,85 +478,116 @@ void local_search(Custom_CDT& custom_cdt, Polygon& polygon, int& L, const std_st
     int init_vertices = custom_cdt.number_of_vertices();
     int init_num_obtuses = count_obtuse_triangles(custom_cdt, polygon);
     double p_sum = 0.0;
+    //The random steiners around the centroid (3rd task)
+    std::mt19937 centroid_rng(next_random_seed());
     time_t start_time, end_time; 
     time(&start_time);
     Custom_CDT best_cdt = custom_cdt;
+    //Dual kernel mode: the candidates are scored on a double mirror of custom_cdt
+    bool dual_kernel = dual_kernel_enabled();
+    Inexact_mirror mirror;
+    if (dual_kernel) build_mirror(custom_cdt, polygon, mirror);
+
+    //Insert the steiner of method on face for real and update the counters. The score may differ in the order
+    //of the flips, keep it only if it really improves. Return true if it was kept.
+    auto apply_move = [&](const Face_handle& face, int method) -> bool {
+        Point_2 steiner_point;
+        //Midpoint edge: We need this edge to check if the steiner was entered on the boundary
+        Segment_2 longest_edge;
+        //Projection edge: We need this edge to check if the steiner was entered on the boundary
+        Segment_2 opposide_edge;
+        num_of_obtuses_before = count_obtuse_triangles(custom_cdt, polygon);
+        custom_cdt.begin_transaction();
+        insert_local_search_steiner(custom_cdt, method, face, polygon, steiner_point, longest_edge, opposide_edge, true);
+        unsigned int obtuses_after = count_obtuse_triangles(custom_cdt, polygon);
+        if (obtuses_after >= obtuse_best_cdt) {
+            custom_cdt.rollback_transaction();
+            return false;
+        }
+        custom_cdt.commit_transaction();
+        best_cdt = custom_cdt;
+        obtuse_best_cdt = count_obtuse_triangles(best_cdt, polygon);
+        if(run_auto_method){                
+            //3rd task
+            if(try_randomization){
+                in_randomization = true;
+                cout<<"Random steiner inserted: "<<temp_random_steiner<<endl;
+                random_steiners.emplace_back(temp_random_steiner);
+                count_steiners[5]++;
+                try_randomization = false;
+            }
+            else progress = true;
+        }
+
+        count_steiners[method]++;
+        //3rd task
+        if(run_auto_method){
+            num_of_steiners = custom_cdt.number_of_vertices() - init_vertices;
+            p_sum += p_sum_function(num_of_steiners - 1, num_of_obtuses_before, obtuses_after);
+        }
 
-    while(L > 0){
+        //For projection or midpoint check if the steiner inserted in the boundary of polygon and update the polygon
+        if(method == 1) update_polygon(polygon, steiner_point, longest_edge.source(), longest_edge.target());
+        if(method == 2) update_polygon(polygon, steiner_point, opposide_edge.source(), opposide_edge.target());
+        //The adjacent method inserts several points, copy the mirror again
+        if (dual_kernel && method == 3) build_mirror(custom_cdt, polygon, mirror);
+        else if (dual_kernel) mirror_insert(mirror, custom_cdt, polygon, steiner_point);
+        return true;
+    };
+    //Parallel mode: the triangulations of the workers, kept between the rounds
+    vector<Custom_CDT> clones;
+    //Checkpoint of the best cdt and of the remaining L, a resumed run continues with the L of its checkpoint
+    Checkpoint checkpoint;
+    if (take_resume_checkpoint("local", checkpoint)) L = checkpoint.iteration;
+    auto save_local_checkpoint = [&]() {
+        checkpoint.iteration = L;
+        save_checkpoint("local", best_cdt, polygon, checkpoint);
+    };
+
+    while(L > 0 && !search_should_stop()){
+        if (checkpoint_due()) save_local_checkpoint();
         progress = false;
-        for (auto face = custom_cdt.finite_faces_begin(); face != custom_cdt.finite_faces_end(); ++face) {
+        obtuse_best_cdt = count_obtuse_triangles(best_cdt, polygon);
+        //Parallel mode: score every method on every obtuse face at once and apply the best move
+        if (num_threads > 1) {
+            vector<Face_handle> obtuse_faces;
+            for (auto face = custom_cdt.finite_faces_begin(); face != custom_cdt.finite_faces_end(); ++face) {
+                if (is_obtuse(face) && is_face_inside_region(face)) obtuse_faces.push_back(face);
+            }
+            int best_face = -1, best_method = -1;
+            unsigned int best_obtuses = 0;
+            best_local_search_move(custom_cdt, polygon, obtuse_faces, num_threads, clones, best_face, best_method, best_obtuses,
+                                   dual_kernel ? &mirror : nullptr);
+            if (best_face >= 0 && best_obtuses < obtuse_best_cdt) apply_move(obtuse_faces[best_face], best_method);
+        }
+        else for (auto face = custom_cdt.finite_faces_begin(); face != custom_cdt.finite_faces_end(); ++face) {
+            if (search_should_stop()) break;
             if (!is_obtuse(face)) continue;
-            if (!is_face_inside_region(face, polygon)) continue;
+            if (!is_face_inside_region(face)) continue;
             
-            //Create temporary CDT copies for each method
-            Custom_CDT cdt_circum = custom_cdt;
-            Custom_CDT cdt_midpoint = custom_cdt;
-            Custom_CDT cdt_projection = custom_cdt;
-            Custom_CDT cdt_adjacent = custom_cdt;
-            Custom_CDT cdt_centroid = custom_cdt;
-            vector<Custom_CDT> cdt_variants = {cdt_circum, cdt_midpoint, cdt_projection, cdt_adjacent, 
-                                                cdt_centroid};
-            vector<Point_2> steiner_points(6);
-            //Midpoint edge: We need this edge to check if the steiner was entered on the boundary
-            Segment_2 longest_edge;
-            //Projection edge: We need this edge to check if the steiner was entered on the boundary
-            Segment_2 opposide_edge;
-            //Apply Steiner point insertion methods
-            insert_circumcenter(cdt_variants[0], face, polygon, steiner_points[0]);// dont_use_circumcenter = true;
-            insert_midpoint(cdt_variants[1], face, polygon, steiner_points[1], longest_edge);
-            insert_projection(cdt_variants[2], face, polygon, steiner_points[2], opposide_edge);
-            insert_adjacent_steiner_local_search(cdt_variants[3], face, polygon, steiner_points[3]);
-            insert_centroid(cdt_variants[4], face, polygon, steiner_points[4]);
-
-            //Vector to store obtuse counts
-            vector<unsigned int> obtuses_after(5);
-
-            for (int i = 0; i < cdt_variants.size(); ++i) {
-                obtuses_after[i] = count_obtuse_triangles(cdt_variants[i], polygon);
+            //Score every Steiner point insertion method without modifying the cdt (on the mirror if it can answer)
+            vector<unsigned int> obtuses_after(NUM_LOCAL_SEARCH_METHODS);
+            Mirror_face mirror_face;
+            if (dual_kernel) mirror_face = mirror_face_of(face);
+            for (int method = 0; method < obtuses_after.size(); ++method) {
+                Mirror_score score;
+                if (dual_kernel && mirror_evaluate(mirror, method, mirror_face, score)) {
+                    obtuses_after[method] = count_obtuse_triangles(custom_cdt, polygon) + score.obtuse_delta;
+                }
+                else obtuses_after[method] = score_local_search_steiner(custom_cdt, method, face, polygon);
             }
             //Find the method with the minimum obtuse triangles
             auto min_iter = std::min_element(obtuses_after.begin(), obtuses_after.end());
             unsigned int min_index = std::distance(obtuses_after.begin(), min_iter);
-            obtuse_best_cdt = count_obtuse_triangles(best_cdt, polygon);
             //Apply the best method
-            if (obtuses_after[min_index] < obtuse_best_cdt) {
-                num_of_obtuses_before = count_obtuse_triangles(custom_cdt, polygon);
-                custom_cdt.insert_no_flip(steiner_points[min_index]);
-                start_the_flips(custom_cdt, polygon);
-                custom_cdt = cdt_variants[min_index];
-                best_cdt = custom_cdt;
-                obtuse_best_cdt = count_obtuse_triangles(best_cdt, polygon);
-                if(run_auto_method){                
-                    //3rd task
-                    if(try_randomization){
-                        in_randomization = true;
-                        cout<<"Random steiner inserted: "<<temp_random_steiner<<endl;
-                        random_steiners.emplace_back(temp_random_steiner);
-                        count_steiners[5]++;
-                        try_randomization = false;
-                    }
-                    else progress = true;
-                }
-
-                count_steiners[min_index]++;
-                //3rd task
-                if(run_auto_method){
-                    num_of_steiners = custom_cdt.number_of_vertices() - init_vertices;
-                    p_sum += p_sum_function(num_of_steiners - 1, num_of_obtuses_before, obtuses_after[min_index]);
-                }
-
-                //For projection or midpoint check if the steiner inserted in the boundary of polygon and update the polygon
-                if(min_index == 1) update_polygon(polygon, steiner_points[min_index], longest_edge.source(), longest_edge.target());
-                if(min_index == 2) update_polygon(polygon, steiner_points[min_index], opposide_edge.source(), opposide_edge.target());
-                break; //Restart iteration
-            }
+            if (obtuses_after[min_index] < obtuse_best_cdt && apply_move(face, min_index)) break; //Restart iteration
         }
         
         if(!progress){
             L--;
             custom_cdt = best_cdt;
             if(run_auto_method){
-                try_steiner_around_centroid(custom_cdt, polygon, temp_random_steiner);
+                try_steiner_around_centroid(custom_cdt, polygon, temp_random_steiner, centroid_rng);
                 obtuse_custom = count_obtuse_triangles(custom_cdt, polygon);
                 obtuse_best_cdt = count_obtuse_triangles(best_cdt, polygon);
                 
@@ -424,10 +600,13 @@ void local_search(Custom_CDT& custom_cdt, Polygon& polygon, int& L, const std_st
                     try_randomization = false;
                     cout<<"Random steiner inserted: "<<temp_random_steiner<<endl;
                 }
-                //Try this new cdt
+                //Try this new cdt, the centroid steiner changed custom_cdt
+                if (dual_kernel) build_mirror(custom_cdt, polygon, mirror);
             }
         }
     }
+    //A stopped run leaves its state for -resume
+    if (search_should_stop()) save_local_checkpoint();
 
     custom_cdt = best_cdt;
     if(run_auto_method){
@@ -462,12 +641,12 @@ double calculate_energy(const int obtuse_faces, const int steiner_points, const
     return alpha * obtuse_faces + beta * steiner_points;
 }
 
-bool should_accept_bad_steiner(const double deltaE, const double T) {
+bool should_accept_bad_steiner(const double deltaE, const double T, std::mt19937& rng) {
     //Compute e^(-∆E / T)
     double probability = exp(-deltaE / T);
     
-    //Generate R uniformly in [0, 1]
-    double R = static_cast<double>(rand()) / RAND_MAX;
+    //Generate R uniformly in [0, 1], from the generator of the chain
+    double R = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
 
     //Accept transition if e^(-∆E / T) ≥ R
     return probability >= R;
@@ -486,195 +665,468 @@ double p_sum_function(int n_steiner, int previous_obtuses, int obtuse_faces){
 }
 
 
-//Simualated annealing method
-void simulated_annealing(Custom_CDT& custom_cdt, Polygon& polygon, int max_iterations, const double& alpha, 
-                        const double& beta, const int& batch_size, const std_string& name_of_instance, 
-                        bool& randomization, vector<int> subset, std_string category, const bool& run_auto_method){
-    int obtuse_faces = count_obtuse_triangles(custom_cdt, polygon);
-    
-    int init_vertices = custom_cdt.number_of_vertices();
-    double T = 1.0, delta_E = 0.0, E_new = 0.0, cooling_rate = 0.99, min_temp = 1e-6;
-    double best_E = calculate_energy(obtuse_faces, 0, alpha, beta);
-    int num_of_transition = 0, random_steiner = 0;
-    vector<int> count_steiners(6, 0), temp_counter_steiner(6,0);
-    Custom_CDT simulate_cdt = custom_cdt, best_cdt = custom_cdt, curent_cdt = custom_cdt;
-   
-    //These edges are Midpoint and opposite Projection edges, we need these edges to check, if these steiners was entered on the boundary
-    Segment_2 longest_edge, opposite_edge;
-    int best_num_steiner = 0, best_obtuse_faces = obtuse_faces, counter_steiner = 0;
-    bool obtuse_neighbors = false, is_polygon_convex = false, try_randomization = false;
+//A walk of simulated annealing from cdt, all the random choices come from seed
+SA_state::SA_state(const Custom_CDT& cdt, const Polygon& initial_polygon, unsigned int seed, const double& alpha, 
+                    const double& beta) : curent_cdt(cdt), best_cdt(cdt), polygon(initial_polygon), rng(seed), seed(seed){
+    init_vertices = cdt.number_of_vertices();
+    obtuse_faces = best_obtuse_faces = previous_obtuses = count_obtuse_triangles(cdt, polygon);
+    best_E = calculate_energy(obtuse_faces, 0, alpha, beta);
+    dual_kernel = dual_kernel_enabled();
+    if (dual_kernel) build_mirror(curent_cdt, polygon, mirror);
+}
 
-    //From the random number generator choose method from values vector
-    std::mt19937 rng(std::random_device{}()); // Initialize RNG
-    vector<int> values = subset; // Define possible values
-    std::uniform_int_distribution<int> dist(0, values.size() - 1);
+//One sweep of simulated annealing at temperature T: as many proposals as obtuse faces of the current triangulation,
+//it stops at the first accepted steiner. i is the iteration of the sweep, reheat enables the reheats of the schedule
+void annealing_sweep(SA_state& state, double& T, int i, int max_iterations, const double& alpha, const double& beta, 
+                    const int& batch_size, const vector<int>& subset, const bool& run_auto_method, bool reheat){
+    Custom_CDT& curent_cdt = state.curent_cdt;
+    Custom_CDT& best_cdt = state.best_cdt;
+    Polygon& polygon = state.polygon;
+    std::mt19937& rng = state.rng;
+    int& obtuse_faces = state.obtuse_faces;
+    int& best_obtuse_faces = state.best_obtuse_faces;
+    int& num_of_transition = state.num_of_transition;
+    int& previous_obtuses = state.previous_obtuses;
+    const int& init_vertices = state.init_vertices;
+    double& best_E = state.best_E;
+    double& p_sum = state.p_sum;
+    double& p_sum_best = state.p_sum_best;
+    double& temp_p_sum = state.temp_p_sum;
+    vector<int>& count_steiners = state.count_steiners;
+    vector<int>& temp_counter_steiner = state.temp_counter_steiner;
+    vector<Point_2>& vector_random_steiners = state.vector_random_steiners;
+    Point_2& temp_random_steiner = state.temp_random_steiner;
+    bool& try_randomization = state.try_randomization;
+    bool& randomization = state.randomization;
 
-    //3rd task
-    int init_num_obtuses = obtuse_faces;
-    double p_sum = 0.0, p_sum_best = 0.0, temp_p_sum = 0;
-    int previous_obtuses = obtuse_faces, previous_num_steiner = 0;
+    //These edges are Midpoint and opposite Projection edges, we need these edges to check, if these steiners was entered on the boundary
+    Segment_2 longest_edge, opposite_edge;
+    Point_2 steiner_point;
+    int random_steiner = 0, counter_steiner = 0;
+    double delta_E = 0.0, E_new = 0.0;
+    bool inserted = false;
+    //From the random number generator choose method from subset
+    std::uniform_int_distribution<int> dist(0, subset.size() - 1);
+
+    //As many proposals as obtuse faces, every one on a random obtuse face (not always the first faces of the cdt)
+    int proposals = count_obtuse_triangles(curent_cdt, polygon);
+    for (int proposal = 0; proposal < proposals; ++proposal){
+        Face_handle face = give_random_obtuse(curent_cdt, polygon, rng);
+        if (face == Face_handle()) break;
+        //Choose a random steiner from vector
+        random_steiner = subset[dist(rng)];
+        //Find the steiner point, only the accepted ones are inserted. On the mirror it is found and scored in doubles,
+        //the exact steiner is constructed only for an accepted proposal
+        Mirror_score score;
+        bool on_mirror = state.dual_kernel && mirror_evaluate(state.mirror, random_steiner, mirror_face_of(face), score);
+        if(on_mirror) inserted = score.found;
+        else inserted = find_steiner_point(curent_cdt, random_steiner, face, polygon, steiner_point, longest_edge, opposite_edge);
+        //If circumcenter steiner is outside of the boundary, continue
+        if(!inserted && random_steiner == 0) continue;
+        //If the polygon of the adjacent steiner is not convex or if the face has no obtuse neighbors, use the projection
+        if(!inserted && random_steiner == 3){
+            random_steiner = PROJECTION;
+            inserted = find_steiner_point(curent_cdt, random_steiner, face, polygon, steiner_point, longest_edge, opposite_edge);
+        }
+        //Score the steiner without modifying curent_cdt
+        obtuse_faces = count_obtuse_triangles(curent_cdt, polygon);
+        counter_steiner = curent_cdt.number_of_vertices() - init_vertices;
+        if(inserted){
+            Insertion_delta delta;
+            if(on_mirror){
+                delta.valid = score.valid;
+                delta.obtuse_delta = score.obtuse_delta;
+            }
+            else delta = evaluate_steiner(curent_cdt, polygon, steiner_point);
+            if(delta.valid){
+                obtuse_faces += delta.obtuse_delta;
+                counter_steiner++;
+            }
+        }
+        E_new = calculate_energy(obtuse_faces, counter_steiner, alpha, beta);
+        delta_E = E_new - best_E;
 
-    fill(temp_counter_steiner.begin(), temp_counter_steiner.end(), 0);
-    time_t start_time, end_time; 
-    time(&start_time);
-    vector<Point_2> vector_random_steiners;
-    Point_2 temp_random_steiner, steiner_point;
+        //For any undetectable program error
+        if (delta_E == 0) {
+            //cout<<"EROOR delta_E == 0"<<endl;
+            continue;
+        }
+        //Trick to insert into should_accept_bad_steiner(delta_E,T) to reintroduce triangulation as best_cdt because we have increase the obtuses by 3
+        if (delta_E >= (3*alpha)) delta_E = 0.000001;
+        
+        if(delta_E < 0){
+            //The exact steiner of the proposal, the rounding of the mirror may have found one that does not exist
+            if(on_mirror && inserted && !find_steiner_point(curent_cdt, random_steiner, face, polygon, steiner_point, longest_edge, opposite_edge)) continue;
+            if(inserted) snap_steiner_point(curent_cdt, polygon, steiner_point);
+            //Insert the steiner for real. The prediction may differ in the order of the flips, keep it only if it really improves
+            curent_cdt.begin_transaction();
+            if(inserted) start_the_flips(curent_cdt, polygon, curent_cdt.insert_no_flip(steiner_point));
+            obtuse_faces = count_obtuse_triangles(curent_cdt, polygon);
+            counter_steiner = curent_cdt.number_of_vertices() - init_vertices;
+            E_new = calculate_energy(obtuse_faces, counter_steiner, alpha, beta);
+            if(E_new >= best_E){
+                curent_cdt.rollback_transaction();
+                continue;
+            }
+            curent_cdt.commit_transaction();
+            //Update the best value
+            best_cdt = curent_cdt;
+            best_E = E_new;
 
-    for (int i = 0; i < max_iterations && T > min_temp; ++i) {
-        if (obtuse_faces == 0) break;
-        //After from brake, or finite_faces_end(), keep the simulate_cdt as curent_cdt
-        curent_cdt = simulate_cdt;
-        for (auto face = curent_cdt.finite_faces_begin(); face != curent_cdt.finite_faces_end(); ++face){
-            if (!is_obtuse(face)) continue;
-            if (!is_face_inside_region(face, polygon)) continue;
-            //Choose a random steiner from vector
-            random_steiner = values[dist(rng)];
-            switch(random_steiner){
-                //If circumcenter steiner is outside of the boundary, continue
-                case 0: 
-                    if(!insert_circumcenter(simulate_cdt, face, polygon, steiner_point)) continue;
-                    
-                    break;
-                case 1: insert_midpoint(simulate_cdt, face, polygon, steiner_point, longest_edge); break;
-                case 2: insert_projection(simulate_cdt, face, polygon, steiner_point, opposite_edge); break;
-                case 3:
-                    //If the polygon of the adjacent steiner is not convex or if the face has no obtuse neighbors, skip the face
-                    is_polygon_convex = insert_adjacent_steiner(simulate_cdt, face, polygon, steiner_point);
-                    if((!is_polygon_convex)){
-                        insert_projection(simulate_cdt, face, polygon, steiner_point, opposite_edge);
-                        random_steiner = PROJECTION;
-                    }
-                    break;
-                case 4: insert_centroid(simulate_cdt, face, polygon, steiner_point); break;
-                default: break;
+            //Optional for prints
+            best_obtuse_faces = obtuse_faces;
+            //3rd task
+            if(run_auto_method){                
+                p_sum += p_sum_function(counter_steiner - 1, previous_obtuses, obtuse_faces) + temp_p_sum;
+                previous_obtuses = obtuse_faces;
+                temp_p_sum = 0;
+                p_sum_best = p_sum;
+            }
+            
+            //Restart the counter of bad steiner insertions
+            num_of_transition = 0;
+            //Update the counters for steiners
+            temp_counter_steiner[random_steiner]++;
+            //3rd task for the output stats file
+            for(int i = 0; i < temp_counter_steiner.size(); ++i) {
+                count_steiners[i] += temp_counter_steiner[i];
             }
-            obtuse_faces = count_obtuse_triangles(simulate_cdt, polygon);
-            counter_steiner = simulate_cdt.number_of_vertices() - init_vertices;
-            E_new = calculate_energy(obtuse_faces, counter_steiner, alpha, beta);
-            delta_E = E_new - best_E;
 
-            //For any undetectable program error
-            if (delta_E == 0) {
-                simulate_cdt = curent_cdt;
-                //cout<<"EROOR delta_E == 0"<<endl;
-                continue;
+            if(try_randomization && run_auto_method){
+                cout<<"Random steiner inserted: "<<temp_random_steiner<<endl;
+                vector_random_steiners.emplace_back(temp_random_steiner);
+                randomization = true;
+                try_randomization = false;
+            }
+           
+            //For projection or midpoint check if the steiner inserted in the boundary of polygon and update the polygon
+            if(random_steiner == 1) update_polygon(polygon, steiner_point, longest_edge.source(), longest_edge.target());
+            if(random_steiner == 2) update_polygon(polygon, steiner_point, opposite_edge.source(), opposite_edge.target());
+            if(state.dual_kernel && inserted) mirror_insert(state.mirror, curent_cdt, polygon, steiner_point);
+            fill(temp_counter_steiner.begin(), temp_counter_steiner.end(), 0);
+            break;
+        }
+        else if(should_accept_bad_steiner(delta_E, T, rng)){
+            if(on_mirror && inserted && !find_steiner_point(curent_cdt, random_steiner, face, polygon, steiner_point, longest_edge, opposite_edge)) continue;
+            //Insert the (bad) steiner
+            if(inserted) snap_steiner_point(curent_cdt, polygon, steiner_point);
+            if(inserted) start_the_flips(curent_cdt, polygon, curent_cdt.insert_no_flip(steiner_point));
+            if(state.dual_kernel && inserted) mirror_insert(state.mirror, curent_cdt, polygon, steiner_point);
+            obtuse_faces = count_obtuse_triangles(curent_cdt, polygon);
+            counter_steiner = curent_cdt.number_of_vertices() - init_vertices;
+            num_of_transition++;
+            //3rd task
+            if(run_auto_method){
+                temp_p_sum += p_sum_function(counter_steiner - 1, previous_obtuses, obtuse_faces);
+                previous_obtuses = obtuse_faces;
             }
-            //Trick to insert into should_accept_bad_steiner(delta_E,T) to reintroduce triangulation as best_cdt because we have increase the obtuses by 3
-            if (delta_E >= (3*alpha)) delta_E = 0.000001;
             
-            if(delta_E < 0){
-                //Update the iterator
-                curent_cdt = simulate_cdt;
-                //Update the best value
-                best_cdt = simulate_cdt;
-                best_E = E_new;
-
-                //Optional for prints
-                best_obtuse_faces = obtuse_faces;
-                //3rd task
-                if(run_auto_method){                
-                    p_sum += p_sum_function(counter_steiner - 1, previous_obtuses, obtuse_faces) + temp_p_sum;
-                    previous_obtuses = obtuse_faces;
-                    temp_p_sum = 0;
-                    p_sum_best = p_sum;
-                }
-                
-                //Restart the counter of bad steiner insertions
+            temp_counter_steiner[random_steiner]++;
+            //If we havn't improve after from 5 steiner insertion or if we have increase the obtuses by 3, reset the simulated_cdt
+            if(num_of_transition >= batch_size || delta_E >= (3*alpha) || delta_E == 0.000001){
+                curent_cdt = best_cdt; //Reset to the best triangulation
                 num_of_transition = 0;
-                //Update the counters for steiners
-                temp_counter_steiner[random_steiner]++;
-                //3rd task for the output stats file
-                for(int i = 0; i < temp_counter_steiner.size(); ++i) {
-                    count_steiners[i] += temp_counter_steiner[i];
-                }
-
-                if(try_randomization && run_auto_method){
-                    cout<<"Random steiner inserted: "<<temp_random_steiner<<endl;
-                    vector_random_steiners.emplace_back(temp_random_steiner);
-                    randomization = true;
-                    try_randomization = false;
-                }
-               
-                //For projection or midpoint check if the steiner inserted in the boundary of polygon and update the polygon
-                if(random_steiner == 1) update_polygon(polygon, steiner_point, longest_edge.source(), longest_edge.target());
-                if(random_steiner == 2) update_polygon(polygon, steiner_point, opposite_edge.source(), opposite_edge.target());
+                temp_p_sum = 0;
                 fill(temp_counter_steiner.begin(), temp_counter_steiner.end(), 0);
-                break;
-            }
-            else if(should_accept_bad_steiner(delta_E,T)){
-                num_of_transition++;
-                //3rd task
-                if(run_auto_method){
-                    temp_p_sum += p_sum_function(counter_steiner - 1, previous_obtuses, obtuse_faces);
-                    previous_obtuses = obtuse_faces;
-                }
-                
-                //Run the for loop with the simulated_cdt
-                curent_cdt = simulate_cdt;
-                temp_counter_steiner[random_steiner]++;
-                //If we havn't improve after from 5 steiner insertion or if we have increase the obtuses by 3, reset the simulated_cdt
-                if(num_of_transition >= batch_size || delta_E >= (3*alpha) || delta_E == 0.000001){
-                    simulate_cdt = best_cdt; //Reset to the best triangulation
-                    curent_cdt = best_cdt;
-                    num_of_transition = 0;
-                    temp_p_sum = 0;
-                    fill(temp_counter_steiner.begin(), temp_counter_steiner.end(), 0);
-                    //Try to insert insert_steiner_around_centroid (3rd task)
-                    if(i > max_iterations/1.5 && best_obtuse_faces > 1 && run_auto_method) {
-                        try_steiner_around_centroid(simulate_cdt, polygon, temp_random_steiner);
-                        temp_counter_steiner[5]++;
-                        try_randomization = true;
-                        num_of_transition++;
-                        curent_cdt = simulate_cdt;
-                        obtuse_faces = count_obtuse_triangles(simulate_cdt, polygon);
-                        if(best_obtuse_faces > obtuse_faces) {
-                            cout<<"Random steiner inserted: "<<temp_random_steiner<<endl;
-                            vector_random_steiners.emplace_back(temp_random_steiner);
-                            randomization = true;
-                            count_steiners[5]++;
-                            fill(temp_counter_steiner.begin(), temp_counter_steiner.end(), 0);
-                            best_cdt = curent_cdt;
-                            simulate_cdt = curent_cdt;
-                            best_obtuse_faces = obtuse_faces;
-                            num_of_transition = 0;
-                            try_randomization = false;  
-                        }
+                //Try to insert insert_steiner_around_centroid (3rd task)
+                if(i > max_iterations/1.5 && best_obtuse_faces > 1 && run_auto_method) {
+                    try_steiner_around_centroid(curent_cdt, polygon, temp_random_steiner, rng);
+                    temp_counter_steiner[5]++;
+                    try_randomization = true;
+                    num_of_transition++;
+                    obtuse_faces = count_obtuse_triangles(curent_cdt, polygon);
+                    if(best_obtuse_faces > obtuse_faces) {
+                        cout<<"Random steiner inserted: "<<temp_random_steiner<<endl;
+                        vector_random_steiners.emplace_back(temp_random_steiner);
+                        randomization = true;
+                        count_steiners[5]++;
+                        fill(temp_counter_steiner.begin(), temp_counter_steiner.end(), 0);
+                        best_cdt = curent_cdt;
+                        best_obtuse_faces = obtuse_faces;
+                        num_of_transition = 0;
+                        try_randomization = false;  
                     }
                 }
-                break;
+                if(state.dual_kernel) build_mirror(curent_cdt, polygon, state.mirror);
             }
-            //Go up to the "valley", Update temperature (increase)
-            if (T < 1.0 && ((i > 180 && i < 190) || (i > 320 && i < 330))) T = T*1.4;
-            if (T < 1.0 && ((i > 440 && i < 450) || (i > 560 && i < 570))) T = T*1.4;
-            if (T < 1.0 && ((i > 680 && i < 690) || (i > 830 && i < 840))) T = T*1.4;
-            if (T < 1.0 && ((i > 940 && i < 950))) T = T*1.4;
-            
-            //Case that we didn't insert this steiner into simulate_cdt. So, take back the previous simulate_cdt (custom_cdt)
-            simulate_cdt = curent_cdt;
+            break;
         }
-        //Update temperature (decrease)
-        T = T*(cooling_rate);
-        //cout<<"Iteration: " <<i<< ", T: "<<T<<", best_obtuse_faces: "<<best_obtuse_faces<<" best_E: "<<best_E<<endl; 
+        //Go up to the "valley", Update temperature (increase)
+        if (!reheat) continue;
+        if (T < 1.0 && ((i > 180 && i < 190) || (i > 320 && i < 330))) T = T*1.4;
+        if (T < 1.0 && ((i > 440 && i < 450) || (i > 560 && i < 570))) T = T*1.4;
+        if (T < 1.0 && ((i > 680 && i < 690) || (i > 830 && i < 840))) T = T*1.4;
+        if (T < 1.0 && ((i > 940 && i < 950))) T = T*1.4;
+        
     }
+}
 
-    //"Return" the best cdt
-    custom_cdt = best_cdt;
+//The best triangulation of an annealing walk and its stats
+SA_chain_result annealing_result(SA_state& state, const double& alpha, const double& beta, const bool& run_auto_method){
+    SA_chain_result result;
+    result.seed = state.seed;
+    int best_num_steiner = state.best_cdt.number_of_vertices() - state.init_vertices;
     if(run_auto_method){
         double front;
-        best_num_steiner = best_cdt.number_of_vertices() - init_vertices;
         if (best_num_steiner > 1)
             front = abs(1.0/(best_num_steiner - 1.0));
         else front = 0.0;    
-        double rate_of_convergence = front * p_sum_best;
-        
+        result.rate_of_convergence = front * state.p_sum_best;
+    }
+    result.num_steiners = best_num_steiner;
+    result.num_obtuses = count_obtuse_triangles(state.best_cdt, state.polygon);
+    result.energy = calculate_energy(result.num_obtuses, best_num_steiner, alpha, beta);
+    result.randomization = state.randomization;
+    result.count_steiners = state.count_steiners;
+    result.random_steiners = state.vector_random_steiners;
+    result.cdt = std::move(state.best_cdt);
+    result.polygon = state.polygon;
+    return result;
+}
+
+//One chain of simulated annealing from initial_cdt, all the random choices come from seed
+SA_chain_result simulated_annealing_chain(const Custom_CDT& initial_cdt, const Polygon& initial_polygon, int max_iterations,
+                        const double& alpha, const double& beta, const int& batch_size, vector<int> subset,
+                        const bool& run_auto_method, unsigned int seed){
+    SA_state state(initial_cdt, initial_polygon, seed, alpha, beta);
+    double T = 1.0, cooling_rate = 0.99, min_temp = 1e-6;
+    //Checkpoint of the best cdt with the temperature, the iteration and the generator of the chain (only the chain
+    //of the thread of the instance, the chains of -chains have no checkpoint)
+    Checkpoint checkpoint;
+    int first_iteration = 0;
+    if (take_resume_checkpoint("sa", checkpoint)) {
+        T = checkpoint.temperature;
+        first_iteration = checkpoint.iteration;
+        rng_from_string(checkpoint.rng_state, state.rng);
+    }
+
+    for (int i = first_iteration; i < max_iterations && T > min_temp; ++i) {
+        //A stopped run also leaves its state for -resume
+        if (checkpoint_due() || (search_should_stop() && state.obtuse_faces > 0)) {
+            checkpoint.iteration = i;
+            checkpoint.temperature = T;
+            checkpoint.rng_state = rng_to_string(state.rng);
+            save_checkpoint("sa", state.best_cdt, state.polygon, checkpoint);
+        }
+        if (state.obtuse_faces == 0 || search_should_stop()) break;
+        annealing_sweep(state, T, i, max_iterations, alpha, beta, batch_size, subset, run_auto_method, true);
+        //Update temperature (decrease)
+        T = T*(cooling_rate);
+        //cout<<"Iteration: " <<i<< ", T: "<<T<<", best_obtuse_faces: "<<state.best_obtuse_faces<<" best_E: "<<state.best_E<<endl; 
+    }
+    return annealing_result(state, alpha, beta, run_auto_method);
+}
+
+
+//Simualated annealing method, num_chains independent chains on as many threads from the same custom_cdt. 
+//The chain with the lowest energy wins (the first one on a tie)
+void simulated_annealing(Custom_CDT& custom_cdt, Polygon& polygon, int max_iterations, const double& alpha, 
+                        const double& beta, const int& batch_size, const std_string& name_of_instance, 
+                        bool& randomization, vector<int> subset, std_string category, const bool& run_auto_method,
+                        const int& num_chains){
+    time_t start_time, end_time; 
+    time(&start_time);
+    int init_num_obtuses = count_obtuse_triangles(custom_cdt, polygon);
+
+    //The seeds of the chains, drawn in the order of the chains
+    std::mt19937 seeder(next_random_seed());
+    vector<unsigned int> seeds(num_chains);
+    for (unsigned int& seed : seeds) seed = seeder();
+
+    vector<SA_chain_result> chains(num_chains);
+    if (num_chains <= 1) {
+        chains[0] = simulated_annealing_chain(custom_cdt, polygon, max_iterations, alpha, beta, batch_size, subset, 
+                                              run_auto_method, seeds[0]);
+    }
+    else {
+        //The chains only read custom_cdt and polygon, build the region index before they share it
+        polygon.build_region_index();
+        std::chrono::steady_clock::time_point deadline = instance_deadline();
+        vector<exception_ptr> errors(num_chains);
+        vector<thread> workers;
+        for (int c = 0; c < num_chains; ++c) {
+            workers.emplace_back([&, c]() {
+                try {
+                    set_instance_deadline(deadline);
+                    chains[c] = simulated_annealing_chain(custom_cdt, polygon, max_iterations, alpha, beta, batch_size, 
+                                                          subset, run_auto_method, seeds[c]);
+                }
+                catch (...) {
+                    errors[c] = current_exception();
+                }
+            });
+        }
+        for (thread& worker : workers) worker.join();
+        for (const exception_ptr& error : errors) {
+            if (error) rethrow_exception(error);
+        }
+    }
+
+    int winner = 0;
+    for (int c = 1; c < num_chains; ++c) {
+        if (chains[c].energy < chains[winner].energy) winner = c;
+    }
+    std_string chains_summary;
+    if (num_chains > 1) {
+        ostringstream summary;
+        for (int c = 0; c < num_chains; ++c) {
+            summary<<"Chain "<<c<<" (seed "<<chains[c].seed<<"): obtuses "<<chains[c].num_obtuses<<", steiners "
+                   <<chains[c].num_steiners<<", energy "<<chains[c].energy<<(c == winner ? " <= winner" : "")<<endl;
+        }
+        chains_summary = summary.str();
+        cout<<chains_summary;
+    }
+
+    SA_chain_result& best = chains[winner];
+    custom_cdt = std::move(best.cdt);
+    polygon = best.polygon;
+    if (best.randomization) randomization = true;
+    if(run_auto_method){
         std_string method_name = "SA";
+        if (num_chains > 1) method_name += " (chain " + to_string(winner) + " of " + to_string(num_chains) + ")";
         
-        obtuse_faces = count_obtuse_triangles(best_cdt, polygon);
-        best_E  = calculate_energy(obtuse_faces, best_num_steiner, alpha, beta);
+        method_output(best.count_steiners, method_name, name_of_instance, best.num_steiners, init_num_obtuses, 
+                        best.num_obtuses, randomization, best.random_steiners, best.rate_of_convergence, best.energy,
+                        subset, category, chains_summary);
+    }
+    time(&end_time);
+    double time_taken = double(end_time - start_time); 
+    cout<<"Time taken by  : "<<name_of_instance<<" is : "<<" sec "<<time_taken<<endl;    
+}
+
+
+//Parallel tempering: num_replicas annealing walks from custom_cdt at a ladder of fixed temperatures, every one on
+//its own thread, with the moves and the batch resets of simulated annealing but without the reheats. Every 
+//exchange_interval sweeps the neighbouring temperatures swap their walks with probability 
+//min(1, e^((1/T_k - 1/T_k+1) * (E_k - E_k+1))) on the energy of the current triangulations. The walk with the lowest
+//energy wins (the first one on a tie)
+void parallel_tempering(Custom_CDT& custom_cdt, Polygon& polygon, int max_iterations, const double& alpha, 
+                        const double& beta, const int& batch_size, const std_string& name_of_instance, 
+                        bool& randomization, vector<int> subset, std_string category, const bool& run_auto_method,
+                        const int& num_replicas){
+    if (num_replicas < 2) {
+        simulated_annealing(custom_cdt, polygon, max_iterations, alpha, beta, batch_size, name_of_instance, randomization, 
+                            subset, category, run_auto_method);
+        return;
+    }
+    time_t start_time, end_time; 
+    time(&start_time);
+    int init_num_obtuses = count_obtuse_triangles(custom_cdt, polygon);
+    const int exchange_interval = 10;
+    const double max_temp = 1.0, min_temp = 0.01;
+
+    //Geometric ladder, from the hottest to the coldest temperature
+    vector<double> temperatures(num_replicas);
+    for (int k = 0; k < num_replicas; ++k) {
+        temperatures[k] = max_temp * pow(min_temp / max_temp, double(k) / (num_replicas - 1));
+    }
+
+    //The seeds of the walks and of the exchanges, drawn in order. Every random choice of a walk (the proposals and
+    //the steiners around the centroid) comes from its own rng, so a run with -seed does not depend on the threads
+    std::mt19937 seeder(next_random_seed());
+    //The walks read the polygon of custom_cdt, build the region index before they share it
+    polygon.build_region_index();
+    vector<SA_state> walks;
+    walks.reserve(num_replicas);
+    for (int w = 0; w < num_replicas; ++w) walks.emplace_back(custom_cdt, polygon, seeder(), alpha, beta);
+    std::mt19937 exchange_rng(seeder());
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    //walk_at[k] is the walk at the temperature k, an exchange swaps the indices and not the triangulations
+    vector<int> walk_at(num_replicas);
+    for (int k = 0; k < num_replicas; ++k) walk_at[k] = k;
+    vector<int> attempted(num_replicas - 1, 0), accepted(num_replicas - 1, 0);
+    auto walk_energy = [&](const SA_state& walk) {
+        return calculate_energy(count_obtuse_triangles(walk.curent_cdt, walk.polygon), 
+                                walk.curent_cdt.number_of_vertices() - walk.init_vertices, alpha, beta);
+    };
+
+    //Checkpoint of the best walk between the rounds, a resumed run continues from its round with fresh walks
+    Checkpoint checkpoint;
+    int i = 0;
+    if (take_resume_checkpoint("pt", checkpoint)) i = checkpoint.iteration;
+    auto save_pt_checkpoint = [&]() {
+        int best_walk = 0;
+        for (int w = 1; w < num_replicas; ++w) {
+            if (walks[w].best_E < walks[best_walk].best_E) best_walk = w;
+        }
+        checkpoint.iteration = i;
+        save_checkpoint("pt", walks[best_walk].best_cdt, walks[best_walk].polygon, checkpoint);
+    };
+
+    bool solved = false;
+    std::chrono::steady_clock::time_point deadline = instance_deadline();
+    for (; i < max_iterations && !solved && !search_should_stop(); i += exchange_interval) {
+        if (checkpoint_due()) save_pt_checkpoint();
+        int sweeps = std::min(exchange_interval, max_iterations - i);
+        vector<exception_ptr> errors(num_replicas);
+        vector<thread> workers;
+        for (int k = 0; k < num_replicas; ++k) {
+            workers.emplace_back([&, k]() {
+                try {
+                    set_instance_deadline(deadline);
+                    SA_state& walk = walks[walk_at[k]];
+                    double T = temperatures[k];
+                    for (int sweep = 0; sweep < sweeps && walk.obtuse_faces > 0 && !search_should_stop(); ++sweep) {
+                        annealing_sweep(walk, T, i + sweep, max_iterations, alpha, beta, batch_size, subset, 
+                                        run_auto_method, false);
+                    }
+                }
+                catch (...) {
+                    errors[k] = current_exception();
+                }
+            });
+        }
+        for (thread& worker : workers) worker.join();
+        for (const exception_ptr& error : errors) {
+            if (error) rethrow_exception(error);
+        }
+        for (const SA_state& walk : walks) {
+            if (walk.best_obtuse_faces == 0) solved = true;
+        }
+
+        //Exchanges of the even and of the odd pairs of neighbouring temperatures in turn
+        for (int k = (i / exchange_interval) % 2; k + 1 < num_replicas; k += 2) {
+            double exponent = (1.0 / temperatures[k] - 1.0 / temperatures[k + 1]) * 
+                              (walk_energy(walks[walk_at[k]]) - walk_energy(walks[walk_at[k + 1]]));
+            attempted[k]++;
+            if (exponent >= 0 || uniform(exchange_rng) < exp(exponent)) {
+                std::swap(walk_at[k], walk_at[k + 1]);
+                accepted[k]++;
+            }
+        }
+    }
+    if (search_should_stop() && !solved) save_pt_checkpoint();
+
+    vector<SA_chain_result> results;
+    for (SA_state& walk : walks) results.push_back(annealing_result(walk, alpha, beta, run_auto_method));
+    int winner = 0;
+    for (int w = 1; w < num_replicas; ++w) {
+        if (results[w].energy < results[winner].energy) winner = w;
+    }
+    ostringstream summary;
+    for (int k = 0; k < num_replicas; ++k) {
+        const SA_chain_result& walk = results[walk_at[k]];
+        summary<<"T = "<<temperatures[k]<<": walk "<<walk_at[k]<<" (seed "<<walk.seed<<"), obtuses "<<walk.num_obtuses
+               <<", steiners "<<walk.num_steiners<<", energy "<<walk.energy<<(walk_at[k] == winner ? " <= winner" : "")<<endl;
+        if (k + 1 < num_replicas) {
+            summary<<"Exchanges T = "<<temperatures[k]<<" <-> T = "<<temperatures[k + 1]<<": "<<accepted[k]<<" of "
+                   <<attempted[k]<<endl;
+        }
+    }
+    std_string replicas_summary = summary.str();
+    cout<<replicas_summary;
+
+    SA_chain_result& best = results[winner];
+    custom_cdt = std::move(best.cdt);
+    polygon = best.polygon;
+    if (best.randomization) randomization = true;
+    if(run_auto_method){
+        std_string method_name = "PT (walk " + to_string(winner) + " of " + to_string(num_replicas) + ")";
         
-        method_output(count_steiners, method_name, name_of_instance, best_num_steiner, init_num_obtuses, 
-                        best_obtuse_faces, randomization, vector_random_steiners, rate_of_convergence, best_E,
-                        subset, category);
+        method_output(best.count_steiners, method_name, name_of_instance, best.num_steiners, init_num_obtuses, 
+                        best.num_obtuses, randomization, best.random_steiners, best.rate_of_convergence, best.energy,
+                        subset, category, replicas_summary);
     }
     time(&end_time);
     double time_taken = double(end_time - start_time); 
@@ -686,7 +1138,7 @@ void simulated_annealing(Custom_CDT& custom_cdt, Polygon& polygon, int max_itera
 void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, const double& beta, 
                 const double& chi, const double& psi, const double& lamda, const int& L, const int& kappa, 
                 const std_string& name_of_instance, bool& randomization, vector<int> subset, std_string category,
-                const bool& run_auto_method){
+                const bool& run_auto_method, const int& num_threads){
     int init_vertices = custom_cdt.number_of_vertices();
     int obtuse_faces = count_obtuse_triangles(custom_cdt, polygon);
     int init_num_obtuses = obtuse_faces;
@@ -696,10 +1148,9 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
     double best_E = calculate_energy(new_obtuse_faces, 0, alpha, beta);
     int counter_steiner = 0;
     int count_ants = kappa;
-    bool obtuse_neighbors = false, can_we_use_adjacent = false, progress = false, try_randomization = false;
+    bool progress = false, try_randomization = false;
     //If we dont have progress for 4 loops, use random steiner
     int progress_counter = 0, progress_obtuses = obtuse_faces;
-    double ro = 0.0;
     //3rd task
     Point_2 random_steiner;
     vector<Point_2> vector_random_steiners;
@@ -723,7 +1174,7 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
     vector<Ant> ant_reduce_obtuses_vector;
 
     //Ant best_cycle_ant;
-    Ant::initialize_Ants(ants, custom_cdt);
+    Ant::initialize_Ants(ants);
 
     //Initialize pheromones    
     vector<double> taf(NUM_METHODS);
@@ -737,68 +1188,104 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
     }
 
     Point_2 curent_steiner_point;
-    Custom_CDT curent_cdt = custom_cdt;
     Custom_CDT best_cdt = custom_cdt;
     Custom_CDT random_cdt = custom_cdt;
     SteinerMethod curent_method;
 
     //3rd task, choose steiner from values
-    std::mt19937 rng(std::random_device{}()); //Initialize RNG
+    std::mt19937 rng(next_random_seed()); //Initialize RNG, it gives the seeds of the ants
     vector<int> values = subset; //Define possible values
-    std::uniform_int_distribution<int> dist(0, values.size() - 1); //Generate index
     bool choose_auto_method = false;  
+    //Parallel mode: the triangulations of the workers, kept between the cycles
+    vector<Custom_CDT> clones;
+    //Checkpoint of the best cdt with the cycle, the pheromones and the generator of the seeds of the ants
+    Checkpoint checkpoint;
+    int cycle = 0;
+    if (take_resume_checkpoint("ant", checkpoint) && checkpoint.taf.size() == taf.size() && 
+        checkpoint.delta_taf.size() == delta_taf.size()) {
+        cycle = checkpoint.iteration;
+        taf = checkpoint.taf;
+        delta_taf = checkpoint.delta_taf;
+        rng_from_string(checkpoint.rng_state, rng);
+    }
+    auto save_ant_checkpoint = [&]() {
+        checkpoint.iteration = cycle;
+        checkpoint.taf = taf;
+        checkpoint.delta_taf = delta_taf;
+        checkpoint.rng_state = rng_to_string(rng);
+        save_checkpoint("ant", best_cdt, polygon, checkpoint);
+    };
     //Start the L cycles
-    for (int cycle = 0; cycle < L; ++cycle) {
+    for (; cycle < L && !search_should_stop(); ++cycle) {
         if (new_obtuse_faces == 0) break;
+        if (checkpoint_due()) save_ant_checkpoint();
         //Clean the vectors
         ant_reduce_obtuses_vector.clear();
         ant_last_winners_vector.clear();      
-        //Ants
-        for (int ant_index = 0; ant_index < count_ants; ++ant_index) {
-            ants[ant_index].set_Custom_CDT(curent_cdt);
-            //Chose obtuse face and check it, give_random_obtuse has check is_obtuse(face), is_face_inside_region(face, polygon)
-            Face_handle face = give_random_obtuse(ants[ant_index].get_Custom_CDT(), polygon);
+        //All the ants of this cycle score their steiner on the same cdt, without modifying it.
+        //If the try_randomization is activated, use the random_cdt
+        const Custom_CDT& curent_cdt = (run_auto_method && try_randomization) ? random_cdt : best_cdt;
+        int cycle_obtuses = count_obtuse_triangles(curent_cdt, polygon);
+        //Every ant gets its own random stream, the seeds are drawn in order so a seeded run is repeatable
+        vector<unsigned int> ant_seeds(count_ants);
+        for (unsigned int& seed : ant_seeds) seed = rng();
+        //One ant: choose an obtuse face of cdt and a method, find its steiner and score it without modifying cdt
+        auto run_ant = [&](const Custom_CDT& cdt, Polygon& ant_polygon, int ant_index) {
+            std::mt19937 ant_rng(ant_seeds[ant_index]);
+            std::uniform_int_distribution<int> ant_dist(0, values.size() - 1);
+            //Scratch of selectSteinerMethod
+            vector<double> ant_hta = hta;
+            Point_2 ant_steiner_point;
+            Segment_2 ant_longest_edge, ant_opposite_edge;
+            //Chose obtuse face and check it, give_random_obtuse has check is_obtuse(face), is_face_inside_region(face)
+            Face_handle face = give_random_obtuse(cdt, ant_polygon, ant_rng);
             /*Improve triangulation*/
-            ro = calculate_radius_to_height(face, curent_cdt);
-            obtuse_neighbors = has_obtuse_neighbors(curent_cdt, face, polygon);
+            double ant_ro = calculate_radius_to_height(face, cdt);
+            bool ant_obtuse_neighbors = has_obtuse_neighbors(cdt, face, ant_polygon);
+            SteinerMethod ant_method;
 
             //If value vector is [0,1,2,3,4] use the selectSteinerMethod, else, choose method from values
-            if(choose_auto_method) curent_method = (SteinerMethod)values[dist(rng)];
-            else curent_method = selectSteinerMethod(ro, taf, hta, chi, psi, obtuse_neighbors);
+            if(choose_auto_method) ant_method = (SteinerMethod)values[ant_dist(ant_rng)];
+            else ant_method = selectSteinerMethod(ant_ro, taf, ant_hta, chi, psi, ant_obtuse_neighbors, ant_rng);
             
-            switch(curent_method){
+            //Find the steiner point of the method
+            bool inserted = false;
+            switch(ant_method){
                 //If circumcenter steiner is outside of the boundary or the opposite edge of obtuse vertex is constraint, use the centroid
                 case 0: 
-                    if(!insert_circumcenter(curent_cdt, face, polygon, curent_steiner_point)){
-                        insert_centroid(curent_cdt, face, polygon, curent_steiner_point); 
-                        curent_method = CENTROID;
-                        break;
+                    if(!find_circumcenter(cdt, face, ant_polygon, ant_steiner_point)){
+                        ant_steiner_point = CGAL::centroid(face->vertex(0)->point(), face->vertex(1)->point(), face->vertex(2)->point());
+                        ant_method = CENTROID;
                     }
-                    else break;
-                case 1: insert_midpoint(curent_cdt, face, polygon, curent_steiner_point, longest_edge); break;
-                case 2: insert_projection(curent_cdt, face, polygon, curent_steiner_point, opposite_edge); break;
+                    inserted = true;
+                    break;
+                case 1: inserted = find_midpoint(face, ant_polygon, ant_steiner_point, ant_longest_edge); break;
+                case 2: inserted = find_projection(face, ant_polygon, ant_steiner_point, ant_opposite_edge); break;
                 case 3:
                     //If the face has obtuse neighbor(s) and the polygon of adjacent points is convex, then insert the adjacent steiner
-                    can_we_use_adjacent = insert_adjacent_steiner(curent_cdt, face, polygon, curent_steiner_point);
-                    if((!can_we_use_adjacent)){
-                        insert_projection(curent_cdt, face, polygon, curent_steiner_point, opposite_edge);
-                        curent_method = PROJECTION;
+                    inserted = find_adjacent_steiner(cdt, face, ant_polygon, ant_steiner_point);
+                    if(!inserted){
+                        inserted = find_projection(face, ant_polygon, ant_steiner_point, ant_opposite_edge);
+                        ant_method = PROJECTION;
                     }
                     break;
                 default: break;
             }
+            //Score the steiner without modifying cdt
+            Insertion_delta delta;
+            if(inserted) delta = evaluate_steiner(cdt, ant_polygon, ant_steiner_point);
             //Save the No of method into Ant
-            ants[ant_index].set_steiner_method(curent_method);
-            //Save the curent cdt into Ant
-            ants[ant_index].set_Custom_CDT(curent_cdt);
+            ants[ant_index].set_steiner_method(ant_method);
             //Save the steiner into Ant   
-            ants[ant_index].set_steiner(curent_steiner_point);
+            ants[ant_index].set_steiner(ant_steiner_point);
             
-            ants[ant_index].set_num_of_obtuses(count_obtuse_triangles(ants[ant_index].get_Custom_CDT(), polygon));
-            new_obtuse_faces = ants[ant_index].get_num_of_obtuses();
-            counter_steiner = ants[ant_index].get_Custom_CDT().number_of_vertices() - init_vertices;
+            ants[ant_index].set_num_of_obtuses(cycle_obtuses + (delta.valid ? delta.obtuse_delta : 0));
+            int ant_steiners = cdt.number_of_vertices() + (delta.valid ? 1 : 0) - init_vertices;
+            //The faces that the steiner would change are the affected faces of the ant
+            ants[ant_index].clear_ant_affect_faces();
+            for (const Face_handle& affected_face : delta.destroyed_faces) ants[ant_index].set_face_in_ant_affect_faces(affected_face);
             //Save the energy into Ant
-            ants[ant_index].set_energy( calculate_energy(new_obtuse_faces, counter_steiner, alpha, beta) );
+            ants[ant_index].set_energy( calculate_energy(ants[ant_index].get_num_of_obtuses(), ant_steiners, alpha, beta) );
             //Save the DeltaE into Ant
             ants[ant_index].set_DeltaE( (ants[ant_index].get_energy() - best_E) );
             /*Evaluate the resulting triangulation*/
@@ -806,28 +1293,49 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
             if (ants[ant_index].get_DeltaE() < 0) {
                 ants[ant_index].set_reduce_obtuses(true);
                 //Save and the longest_edge, opposite_edge because we need it to update the polygon, if the steiner is on boundary
-                if((ants[ant_index].get_steiner_method() == 1) && polygon.bounded_side(ants[ant_index].get_steiner_point()) == CGAL::ON_BOUNDARY) 
-                    ants[ant_index].set_longest_edge_midpoint(longest_edge);
-                if((ants[ant_index].get_steiner_method() == 2) && polygon.bounded_side(ants[ant_index].get_steiner_point()) == CGAL::ON_BOUNDARY) 
-                    ants[ant_index].set_opposite_edge_projection(opposite_edge);
+                if((ants[ant_index].get_steiner_method() == 1) && ant_polygon.bounded_side(ants[ant_index].get_steiner_point()) == CGAL::ON_BOUNDARY) 
+                    ants[ant_index].set_longest_edge_midpoint(ant_longest_edge);
+                if((ants[ant_index].get_steiner_method() == 2) && ant_polygon.bounded_side(ants[ant_index].get_steiner_point()) == CGAL::ON_BOUNDARY) 
+                    ants[ant_index].set_opposite_edge_projection(ant_opposite_edge);
             }
             else ants[ant_index].set_reduce_obtuses(false);
-            
-            if(run_auto_method){
-                //If the try_randomization is activated, use other cdt
-                if(!try_randomization) curent_cdt = best_cdt;
-                else curent_cdt = random_cdt;
+        };
+        //Ants
+        if (num_threads <= 1) {
+            for (int ant_index = 0; ant_index < count_ants; ++ant_index) run_ant(curent_cdt, polygon, ant_index);
+        }
+        else {
+            //Every worker runs the ants t, t + num_threads, ... on its own clone. The vertex ids are copied with
+            //the clone, so the face keys of the ants are the same as in curent_cdt
+            int num_workers = std::min(num_threads, count_ants);
+            clones.resize(num_workers);
+            vector<exception_ptr> errors(num_workers);
+            vector<thread> workers;
+            for (int t = 0; t < num_workers; ++t) {
+                workers.emplace_back([&, t]() {
+                    try {
+                        clones[t] = curent_cdt;
+                        Polygon worker_polygon = polygon;
+                        for (int ant_index = t; ant_index < count_ants; ant_index += num_workers) {
+                            run_ant(clones[t], worker_polygon, ant_index);
+                        }
+                    }
+                    catch (...) {
+                        errors[t] = current_exception();
+                    }
+                });
+            }
+            for (thread& worker : workers) worker.join();
+            for (const exception_ptr& error : errors) {
+                if (error) rethrow_exception(error);
             }
-            else curent_cdt = best_cdt;
         }
+        if (count_ants > 0) new_obtuse_faces = ants[count_ants - 1].get_num_of_obtuses();
         
         //Save the bests ants (not the last winners)
         for (int ant_index = 0; ant_index < count_ants; ++ant_index){
             //If this ant didnt reduce the obtuses faces of cdt, ignore it
             if(!ants[ant_index].get_reduce_obtuses()) continue;
-            //Compare the best_cdt and ant_cdt to find the differnces in the faces.
-            /*If there are faces in best_cdt that ant_cdt does not have, this means that those faces were affected by ant*/
-            affected_faces(best_cdt, ants[ant_index]);
             //Add this ant into ant_reduce_obtuses_vector
             ant_reduce_obtuses_vector.emplace_back(ants[ant_index]);
         }
@@ -853,17 +1361,17 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
             num_of_obtuses_before = count_obtuse_triangles(best_cdt, polygon);
             //3rd task
             if(try_randomization && run_auto_method) {
-                best_cdt.insert_no_flip(random_steiner);
-                start_the_flips(best_cdt, polygon);
+                start_the_flips(best_cdt, polygon, best_cdt.insert_no_flip(random_steiner));
                 cout<<fixed<<"Random steiner inserted: "<<random_steiner<<endl;
                 inserted_steiners.emplace_back(random_steiner);
                 
             }
-            inserted_steiners.emplace_back(ant_last_winners_vector[i].get_steiner_point());
+            Point_2 winner_steiner = ant_last_winners_vector[i].get_steiner_point();
+            snap_steiner_point(best_cdt, polygon, winner_steiner);
+            inserted_steiners.emplace_back(winner_steiner);
             
             count_steiners[ant_last_winners_vector[i].get_steiner_method()]++;
-            best_cdt.insert_no_flip(ant_last_winners_vector[i].get_steiner_point());
-            start_the_flips(best_cdt, polygon);
+            start_the_flips(best_cdt, polygon, best_cdt.insert_no_flip(winner_steiner));
             if(run_auto_method){
                 //3rd task, p_sum
                 num_of_steiners = best_cdt.number_of_vertices() - init_vertices;
@@ -871,7 +1379,7 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
                 p_sum += p_sum_function(num_of_steiners - 1, num_of_obtuses_before, num_of_obtuses_after);
             }
            
-            curent_steiner_point = ant_last_winners_vector[i].get_steiner_point();
+            curent_steiner_point = winner_steiner;
             longest_edge = ant_last_winners_vector[i].get_longest_edge_midpoint();
             opposite_edge = ant_last_winners_vector[i].get_opposite_edge_projection();
             curent_method = ant_last_winners_vector[i].get_steiner_method();
@@ -900,8 +1408,7 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
             }
             else  progress_counter++;
 
-            //Reset the curent cdt and random_cdt
-            curent_cdt = best_cdt;
+            //Reset the random_cdt
             random_cdt = best_cdt;
             //Try to insert insert_steiner_around_centroid (3rd task)
             if (progress_counter >= non_progress_counter) try_randomization = true;
@@ -909,12 +1416,10 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
                 non_progress_counter = 10;
                 try_randomization = true;
                 progress_counter = 0;
-                try_steiner_around_centroid(random_cdt, polygon, random_steiner);
+                try_steiner_around_centroid(random_cdt, polygon, random_steiner, rng);
                 int obtuses = count_obtuse_triangles(random_cdt, polygon);
-                curent_cdt = random_cdt;
                 if(obtuses < best_obtuses) {
                     best_cdt = random_cdt;
-                    curent_cdt = best_cdt;
                     best_obtuses = obtuses;
                     progress_obtuses = obtuses;
                     counter_steiner = best_cdt.number_of_vertices() - init_vertices;
@@ -931,8 +1436,10 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
         /*Update pheromones*/
         if(ant_reduce_obtuses_vector.size() > 0) updatePheromones(taf, delta_taf, ant_reduce_obtuses_vector, lamda);
         ///Restart the ants
-        Ant::initialize_Ants(ants, best_cdt);
+        Ant::initialize_Ants(ants);
     }    
+    //A stopped run leaves its state for -resume
+    if (search_should_stop() && new_obtuse_faces > 0) save_ant_checkpoint();
     cout<<endl;
     //Return the best cdt
     custom_cdt = best_cdt;
@@ -961,16 +1468,14 @@ void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, c
 //Check for conflict between 2 ants
 bool have_conflict(Ant& ant1, Ant& ant2){
   
-    //Take the affected faces of the
-    set<Face_handle> face1 = ant1.get_affected_faces();
-    set<Face_handle> face2 = ant2.get_affected_faces();
-    //For every face of every of 2 ants check if they have same face(s)
-    for (const auto& temp_face1 : face1){
-        for (const auto& temp_face2 : face2){
-            if(are_faces_equal(temp_face1, temp_face2)){
-                return true;
-            }
-        }
+    //Take the affected faces of the 2 ants
+    const Custom_face_key_set& faces1 = ant1.get_affected_faces();
+    const Custom_face_key_set& faces2 = ant2.get_affected_faces();
+    //Look up every face of the smaller set in the other one
+    const Custom_face_key_set& smaller = (faces1.size() <= faces2.size()) ? faces1 : faces2;
+    const Custom_face_key_set& larger = (faces1.size() <= faces2.size()) ? faces2 : faces1;
+    for (const Custom_face_key& key : smaller){
+        if(larger.count(key)) return true;
     }
     return false;
 }
@@ -1019,40 +1524,25 @@ vector<Ant> save_the_best(vector<Ant>& ants){
     return winners;
 }
 
-//Check if two faces are equals
+//Check if two faces are equals (the same face, also in different copies of the cdt)
 bool are_faces_equal(const Face_handle& face1, const Face_handle& face2) {
-    set<Point_2> vertices_face1 = {
-        face1->vertex(0)->point(),
-        face1->vertex(1)->point(),
-        face1->vertex(2)->point()
-    };
-
-    set<Point_2> vertices_face2 = {
-        face2->vertex(0)->point(),
-        face2->vertex(1)->point(),
-        face2->vertex(2)->point()
-    };
-    //Copy the sets into vectors for sorting and comparison
-    vector<Point_2> points_vector_face1(vertices_face1.begin(), vertices_face1.end());
-    vector<Point_2> points_vector_face2(vertices_face2.begin(), vertices_face2.end());
-
-    //Lexicographical Order of the face points. First compare x-coordinates.
-    sort(points_vector_face1.begin(), points_vector_face1.end());
-    sort(points_vector_face2.begin(), points_vector_face2.end());
-
-    return points_vector_face1 == points_vector_face2;
+    return Custom_CDT::face_key(face1) == Custom_CDT::face_key(face2);
 }
 
 //Give a random obtuse face
-Face_handle give_random_obtuse(Custom_CDT& custom_cdt, Polygon& polygon) {
+Face_handle give_random_obtuse(const Custom_CDT& custom_cdt, Polygon& polygon, std::mt19937& generator) {
+    //The cdt keeps the obtuse faces inside the region, draw from them in O(1)
+    if (custom_cdt.has_region()) {
+        Face_handle face = custom_cdt.random_obtuse_face(generator);
+        if (face == Face_handle()) cerr<<"No obtuse faces found!"<<endl;
+        return face;
+    }
     //Container to store faces with obtuse angles
     vector<Face_handle> obtuse_faces;
     obtuse_faces.clear();
-    //Initialize the random number generator with a random device and engine
-    static std::mt19937 generator(std::random_device{}()); //Only initialize once
 
     for (auto face = custom_cdt.finite_faces_begin(); face != custom_cdt.finite_faces_end(); ++face) {
-        if (!is_face_inside_region(face, polygon)) continue;
+        if (!is_face_inside_region(face)) continue;
         if (is_obtuse(face)) {
             obtuse_faces.push_back(face);
         }
@@ -1071,24 +1561,6 @@ Face_handle give_random_obtuse(Custom_CDT& custom_cdt, Polygon& polygon) {
     return obtuse_faces[index];
 }
 
-//Update affected faces
-void affected_faces(Custom_CDT& best_cdt, Ant& ant) {
-    ant.clear_ant_affect_faces();
-    Custom_CDT temp_ant_cdt = ant.get_Custom_CDT();
-    for (auto best_face = best_cdt.finite_faces_begin(); best_face != best_cdt.finite_faces_end(); ++best_face) {
-        bool found_face = false;
-        for (auto ant_face = temp_ant_cdt.finite_faces_begin(); ant_face != temp_ant_cdt.finite_faces_end(); ++ant_face) {
-            //Check the faces if are equals
-            if (are_faces_equal(best_face, ant_face)) {
-                found_face = true;
-                break;
-            }
-        }
-        //If best_face != ant_face means that we have conflict
-        if (!found_face) ant.set_face_in_ant_affect_faces(best_face);
-    }
-}
-
 void printAntDetails(vector<Ant>& ants) {
     cout<<"Number of ants: "<<ants.size() <<endl;
     for (size_t i = 0; i < ants.size(); ++i) {
@@ -1102,16 +1574,11 @@ void printAntDetails(vector<Ant>& ants) {
         cout<<"Conflict? : "<<ants[i].get_conflict()<<endl;
         
         if(ants[i].get_reduce_obtuses()){
-            set<Face_handle> temp_face = ants[i].get_affected_faces();
+            const Custom_face_key_set& temp_face = ants[i].get_affected_faces();
             cout<<"size of vector: "<<ants[i].get_affected_faces().size()<<endl;
             for (const auto& face : temp_face) {
-                for (int j = 0; j < 3; ++j) {  //A triangle has 3 vertices
-                    cout<<endl;
-                    auto vertex = face->vertex(j);
-                    if (vertex != nullptr) cout<<"Point "<<j<<": ("<<vertex->point().x()<<", "<<vertex->point().y()<< ") =>";
-                    else cout<<"Point "<<j<< ": (nullptr)"<<endl;            
-                }
-                cout<<endl;
+                //A triangle has 3 vertices, print their ids
+                cout<<"Face: ("<<face[0]<<", "<<face[1]<<", "<<face[2]<<")"<<endl;
             }
         }
         cout<<"*******************************"<<endl;
@@ -1119,7 +1586,8 @@ void printAntDetails(vector<Ant>& ants) {
     }
 }
 
-SteinerMethod selectSteinerMethod(const double& ro, const vector<double>& taf, vector<double>& hta, double chi, double psi, bool obtuse_neighbors) {
+SteinerMethod selectSteinerMethod(const double& ro, const vector<double>& taf, vector<double>& hta, double chi, double psi, bool obtuse_neighbors,
+                                  std::mt19937& gen) {
     //Ensure inputs are valid
     if (taf.size() != SteinerMethod::NUM_METHODS || hta.size() != SteinerMethod::NUM_METHODS) {
         cerr<<"Error: taf or hta size does not match NUM_METHODS."<<endl;
@@ -1158,8 +1626,6 @@ SteinerMethod selectSteinerMethod(const double& ro, const vector<double>& taf, v
     probabilities[SteinerMethod::NUM_METHODS - 1] += correction;
 
     //Select a method based on the computed probabilities
-    std::random_device rd;
-    std::mt19937 gen(rd());
     std::uniform_real_distribution<> dis(0.0, 1.0);
     double random_value = dis(gen);
 
@@ -1208,31 +1674,9 @@ void updatePheromones(vector<double>& taf, vector<double>& delta_taf, vector<Ant
 }
 
 //Function to compute ρ (radius-to-height ratio)
+//ρ = R / h: circumradius over the height on the longest edge, from the record of the face
 double calculate_radius_to_height(const Face_handle& face, const Custom_CDT& cdt) {
-    //Vertices of the triangle
-    Point p1 = face->vertex(0)->point();
-    Point p2 = face->vertex(1)->point();
-    Point p3 = face->vertex(2)->point();
-
-    //Compute circumradius (R)
-    Point circumcenter = CGAL::circumcenter(p1, p2, p3);
-    double R = sqrt(CGAL::to_double(CGAL::squared_distance(p1, circumcenter)));
-
-    //Compute lengths of edges
-    double d1 = sqrt(CGAL::to_double(CGAL::squared_distance(p1, p2)));
-    double d2 = sqrt(CGAL::to_double(CGAL::squared_distance(p2, p3)));
-    double d3 = sqrt(CGAL::to_double(CGAL::squared_distance(p3, p1)));
-
-    //Find the longest edge (base)
-    double longest_edge = max({d1, d2, d3});
-
-    //Compute the height from the opposite vertex
-    double s = (d1 + d2 + d3) / 2.0; //Semi-perimeter
-    double area = sqrt(s * (s - d1) * (s - d2) * (s - d3)); //Triangle area (Heron's Formula)
-    double height = (2 * area) / longest_edge;
-
-    //Calculate ρ
-    return R / height;
+    return Custom_CDT::face_record(face).rho;
 }
 
 //True if the face has at least 1 obtuse neighbor
@@ -1243,7 +1687,7 @@ bool has_obtuse_neighbors(const Custom_CDT& custom_cdt, const Face_handle& face,
         if (custom_cdt.is_constrained(make_pair(face, i))) continue;
         //Because we have just an iterator, this iterator may go out of bounds
         //because he doesn't have the supervision of for loop
-        if(custom_cdt.is_infinite(neighbor) || !is_face_inside_region(neighbor, polygon)) continue;
+        if(custom_cdt.is_infinite(neighbor) || !is_face_inside_region(neighbor)) continue;
         if(is_obtuse(neighbor)) return true;
     }
     return false;
@@ -1275,17 +1719,16 @@ double hta_mean_adjacent(bool has_obtuse_neighbors) {
 
 //Ιnsert Steiner points at circumcenter
 bool insert_circumcenter(Custom_CDT& circumcenter_cdt, const Face_handle& face, const Polygon& polygon, Point_2& circumcenter_steiner) {    
-    Point_2 p1 = face->vertex(0)->point();
-    Point_2 p2 = face->vertex(1)->point();
-    Point_2 p3 = face->vertex(2)->point();
-    //Find the obtuse vertex
-    Point_2 obtuse_vertex = find_obtuse_vertex(p1, p2, p3);
+    if (!find_circumcenter(circumcenter_cdt, face, polygon, circumcenter_steiner)) return false;
+    start_the_flips(circumcenter_cdt, polygon, circumcenter_cdt.insert_no_flip(circumcenter_steiner));
+    return true;
+}
 
-    //Identify the opposite edge of the obtuse vertex
-    int opposite_edge_index;
-    if (obtuse_vertex == p1) opposite_edge_index = 0;       //Edge (p2, p3)
-    else if (obtuse_vertex == p2) opposite_edge_index = 1;  //Edge (p1, p3)
-    else if (obtuse_vertex == p3) opposite_edge_index = 2;  //Edge (p1, p2)
+//Circumcenter steiner point, return true if it can be inserted: the opposite edge of the obtuse vertex is not
+//constrained and the circumcenter is inside of the region, in a neighbor, and in a face inside of the region
+bool find_circumcenter(const Custom_CDT& circumcenter_cdt, const Face_handle& face, const Polygon& polygon, Point_2& circumcenter_steiner) {
+    //Find the obtuse vertex, the opposite edge of the obtuse vertex has the same index
+    int opposite_edge_index = find_obtuse_vertex_index(face);
 
     auto edge = make_pair(face, opposite_edge_index);
     //Check if the opposite edge is constrained
@@ -1294,16 +1737,17 @@ bool insert_circumcenter(Custom_CDT& circumcenter_cdt, const Face_handle& face,
     }
 
     //Compute the circumcenter of the triangle
+    const Point_2& p1 = face->vertex(0)->point();
+    const Point_2& p2 = face->vertex(1)->point();
+    const Point_2& p3 = face->vertex(2)->point();
     Point_2 circumcenter = CGAL::circumcenter(p1, p2, p3);
     //Circumcenter must be inside of the boundary
     if (is_point_inside_region(circumcenter, polygon) && is_circumcenter_in_neighbor(circumcenter_cdt, face, circumcenter)){
         if(is_convex(p1, p2, p3, circumcenter)){
             //Check the face that the circumcenter will enter must be inside of the boundary
             Face_handle locate_face = circumcenter_cdt.locate(circumcenter);
-            if(is_face_inside_region(locate_face, polygon)){
+            if(is_face_inside_region(locate_face)){
                 circumcenter_steiner = circumcenter;
-                circumcenter_cdt.insert_no_flip(circumcenter);
-                start_the_flips(circumcenter_cdt, polygon);
                 return true;
             }
         }
@@ -1344,8 +1788,30 @@ void insert_centroid(Custom_CDT& centroid_cdt, const Face_handle& face, const Po
     //Compute the centroid of the triangle
     Point_2 centroid = CGAL::centroid(p1, p2, p3);
     centroid_steiner = centroid;
-    centroid_cdt.insert_no_flip(centroid);
-    start_the_flips(centroid_cdt, polygon);
+    start_the_flips(centroid_cdt, polygon, centroid_cdt.insert_no_flip(centroid));
+}
+
+//Steiner point of a method, without inserting it: 0 circumcenter, 1 midpoint, 2 projection, 3 adjacent, 4 centroid.
+//Return false if the insert method would not insert it
+bool find_steiner_point(const Custom_CDT& custom_cdt, int method, const Face_handle& face, const Polygon& polygon,
+                        Point_2& steiner_point, Segment_2& longest_edge, Segment_2& opposide_edge) {
+    switch(method){
+        case 0: return find_circumcenter(custom_cdt, face, polygon, steiner_point);
+        case 1: return find_midpoint(face, polygon, steiner_point, longest_edge);
+        case 2: return find_projection(face, polygon, steiner_point, opposide_edge);
+        case 3: return find_adjacent_steiner(custom_cdt, face, polygon, steiner_point);
+        case 4:
+            steiner_point = CGAL::centroid(face->vertex(0)->point(), face->vertex(1)->point(), face->vertex(2)->point());
+            return true;
+        default: return false;
+    }
+}
+
+//Predicted result of inserting steiner_point with the flips of start_the_flips. The cdt is not modified:
+//the insertion and the flips run on a scratch copy of the faces around the point. polygon is kept for the
+//callers like in start_the_flips
+Insertion_delta evaluate_steiner(const Custom_CDT& custom_cdt, [[maybe_unused]] const Polygon& polygon, const Point_2& steiner_point) {
+    return custom_cdt.evaluate_insertion(steiner_point, accept_flip);
 }
 
 //Ιf we added steiner on boundary of the polygon, update the new edges of the polygon
@@ -1369,6 +1835,33 @@ void update_polygon(Polygon& polygon, const Point_2& steiner_point, const Point_
     }
 }
 
+//Warm start: the points in spatial order, each one located from the vertex before it and inserted without flips,
+//then a single pass of flips over every edge. A point on the region boundary splits its edge of the polygon
+int insert_steiner_points(Custom_CDT& cdt, Polygon& polygon, vector<Point_2> steiner_points) {
+    CGAL::spatial_sort(steiner_points.begin(), steiner_points.end(), K());
+    int inserted = 0;
+    Vertex_handle last;
+    for (const Point_2& steiner_point : steiner_points) {
+        CGAL::Bounded_side side = polygon.bounded_side(steiner_point);
+        if (side == CGAL::ON_UNBOUNDED_SIDE) continue;
+        last = cdt.insert_no_flip(steiner_point, last == Vertex_handle() ? Face_handle() : last->face());
+        inserted++;
+        if (side == CGAL::ON_BOUNDARY) update_polygon(polygon, steiner_point);
+    }
+    start_the_flips(cdt, polygon);
+    return inserted;
+}
+
+//Split the edge of the polygon that has steiner_point inside of it (nothing if it is a vertex or not on the boundary)
+void update_polygon(Polygon& polygon, const Point_2& steiner_point) {
+    for (auto edge = polygon.edges_begin(); edge != polygon.edges_end(); ++edge) {
+        if (edge->has_on(steiner_point) && steiner_point != edge->source() && steiner_point != edge->target()) {
+            update_polygon(polygon, steiner_point, edge->source(), edge->target());
+            return;
+        }
+    }
+}
+
 //Return the number of vertices in a cdt
 int count_vertices(const Custom_CDT& cdt) {
     int count = 0;
@@ -1378,87 +1871,34 @@ int count_vertices(const Custom_CDT& cdt) {
     return count;
 }
 
-//Flips method
-void start_the_flips(Custom_CDT& cdt, const Polygon& polygon){
-    bool progress = true;
-    while(progress){
-        progress = false;
-        for (auto edge = cdt.finite_edges_begin(); edge != cdt.finite_edges_end(); ++edge) {
-            //The face that contains this edge
-            Face_handle f1 = edge->first;
-            //The index of the edge within the face edge->first
-            int i = edge->second;
-            Face_handle f2 = f1->neighbor(i);
-            
-            if(cdt.is_infinite(f1) || cdt.is_infinite(f2)) continue;
-            if(cdt.is_constrained(*edge)) continue;
-            if(!(is_face_inside_region(f1, polygon)) || !(is_face_inside_region(f2, polygon))) continue;
-
-            Point_2 p1 = f1->vertex(cdt.ccw(i))->point(); //First vertex on the shared edge (Counter-Clock Wise)
-            Point_2 p3 = f1->vertex(cdt.cw(i))->point();  //Second vertex on the shared edge (Clock Wise)
-            Point_2 p2 = f1->vertex(i)->point();          //Opposite vertex in the first triangle
-
-            //Check if edge is on boundary or inside of the boundary
-            if(!is_edge_inside_region(p1, p3, polygon)) continue;
-            if(is_edge_on_boundary(p1, p3, polygon)) continue;
-
-            //Mirror index gets the index of the vertex in f2 that is opposite to this shared edge
-            int mirror_index = cdt.mirror_index(f1, i);
-            Point_2 p4 = f2->vertex(mirror_index)->point();         
-            if(is_it_worth_flip(p1, p2, p3, p4)){
-                cdt.flip(f1, i);
-                progress = true;
-                break;
-            }
-            else continue;
-        }
-    }
+//The flip rule of start_the_flips, a constrained edge (the region boundary too) never reaches it
+bool accept_flip(const Point_2& p1, const Point_2& p2, const Point_2& p3, const Point_2& p4) {
+    return is_it_worth_flip(p1, p2, p3, p4);
+}
+
+//Flips method: the worklist flip engine of the Custom CDT. With a seed (usually the Steiner point that was
+//just inserted) only the edges around it are queued at first, without it every edge. The region is in the cdt
+//as constraints, polygon stays in the signature that the Steiner methods share
+Flip_stats start_the_flips(Custom_CDT& cdt, [[maybe_unused]] const Polygon& polygon, Vertex_handle seed){
+    return cdt.flip_edges(seed, accept_flip);
 }
 
 //If 1 point is on the boundary
 bool is_point_inside_region(const Point_2& point, const Polygon& polygon) {
-    //Check if the point is inside the polygon
-    return (polygon.bounded_side(point) == CGAL::ON_BOUNDED_SIDE) || (polygon.bounded_side(point) == CGAL::ON_BOUNDARY);
+    //Check if the point is inside the polygon (the region index of the polygon answers)
+    return polygon.bounded_side(point) != CGAL::ON_UNBOUNDED_SIDE;
 }
 
-//If face is inside of region boundary
-bool is_face_inside_region(const Face_handle& face, const Polygon& polygon) {
-    Point_2 p1 = face->vertex(0)->point();
-    Point_2 p2 = face->vertex(1)->point();
-    Point_2 p3 = face->vertex(2)->point();
-    //Calculate the centroid of the triangle
-    Point_2 centroid = CGAL::centroid(p1, p2, p3);
-
-    //Check if the centroid is inside or on the boundary of the polygon
-    bool centroid_inside = (polygon.bounded_side(centroid) == CGAL::ON_BOUNDED_SIDE ||
-                            polygon.bounded_side(centroid) == CGAL::ON_BOUNDARY);
-
-    if (!centroid_inside) return false;
-    //Check if vertices are inside or on the boundary of the polygon
-    bool vertices_inside = 
-        (polygon.bounded_side(p1) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(p1) == CGAL::ON_BOUNDARY) &&
-        (polygon.bounded_side(p2) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(p2) == CGAL::ON_BOUNDARY) &&
-        (polygon.bounded_side(p3) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(p3) == CGAL::ON_BOUNDARY);
-
-    if (!vertices_inside) return false;
-
-    //Check if edges are fully inside or on the boundary
-    bool edges_inside = 
-        (polygon.bounded_side(CGAL::midpoint(p1, p2)) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(CGAL::midpoint(p1, p2)) == CGAL::ON_BOUNDARY) &&
-        (polygon.bounded_side(CGAL::midpoint(p1, p3)) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(CGAL::midpoint(p1, p3)) == CGAL::ON_BOUNDARY) &&
-        (polygon.bounded_side(CGAL::midpoint(p2, p3)) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(CGAL::midpoint(p2, p3)) == CGAL::ON_BOUNDARY);
-    
-    if (!edges_inside) return false;
-    return true;
+//If face is inside of region boundary. The region boundary is inserted as constraints, so the flood fill
+//domain mark that the Custom CDT keeps up to date on insertions and flips answers it, O(1)
+bool is_face_inside_region(const Face_handle& face) {
+    return Custom_CDT::is_in_domain(face);
 }
 
 //If edge is inside of region boundary
 bool is_edge_inside_region(const Point_2& p1, const Point_2& p2, const Polygon& polygon){
-    bool mids_inside_region = 
-        (polygon.bounded_side(CGAL::midpoint(p1, p2)) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(CGAL::midpoint(p1, p2)) == CGAL::ON_BOUNDARY);
-    bool points_inside_region = 
-        (polygon.bounded_side(p1) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(p1) == CGAL::ON_BOUNDARY) && 
-        (polygon.bounded_side(p2) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(p2) == CGAL::ON_BOUNDARY);
+    bool mids_inside_region = is_point_inside_region(CGAL::midpoint(p1, p2), polygon);
+    bool points_inside_region = is_point_inside_region(p1, polygon) && is_point_inside_region(p2, polygon);
     
     //Check if this edge indersect with an edge of polygon (boundary)
     /*Segment_2 edge(p1, p2);
@@ -1477,54 +1917,34 @@ bool is_edge_inside_region(const Point_2& p1, const Point_2& p2, const Polygon&
     return mids_inside_region && points_inside_region;
 }
 
-//Function to check if an edge is part of the boundary of the polygon
-bool is_edge_on_boundary(const Point_2& p1, const Point_2& p2, const Polygon& polygon) {
-    for (auto edge_it = polygon.edges_begin(); edge_it != polygon.edges_end(); ++edge_it) {
-        if ((edge_it->source() == p1 && edge_it->target() == p2) ||
-            (edge_it->source() == p2 && edge_it->target() == p1)) {
-            return true;
-        }
-    }
-    return false;
+//Function to check if an edge is part of the boundary of the polygon, O(1) from the constraint and domain
+//marks of the cdt
+bool is_edge_on_boundary(const Custom_CDT& custom_cdt, const Face_handle& face, int i) {
+    return custom_cdt.is_boundary_edge(face, i);
 }
 
 Point_2 find_obtuse_vertex(const Point_2& v1, const Point_2& v2, const Point_2& v3) {
-    //Calculate squared distances
-    double ab2 = CGAL::to_double(squared_distance(v1, v2));
-    double ac2 = CGAL::to_double(squared_distance(v1, v3));
-    double bc2 = CGAL::to_double(squared_distance(v2, v3));
-
-    if (ab2 + ac2 < bc2) return v1; //obtuse angle at v1
-    if (ab2 + bc2 < ac2) return v2; //obtuse angle at v2
-    if (ac2 + bc2 < ab2) return v3; //obtuse angle at v3
+    switch (filtered_obtuse_vertex(v1, v2, v3)) {
+        case 0: return v1; //obtuse angle at v1
+        case 1: return v2; //obtuse angle at v2
+        case 2: return v3; //obtuse angle at v3
+        default: break;
+    }
 
     throw logic_error("No obtuse angle found in the triangle.");
 }
 
-//Find the longest edge of a face
-Segment_2 find_longest_edge(const Face_handle& face) {
+//Index of the obtuse vertex of a face, from the record of the face
+int find_obtuse_vertex_index(const Face_handle& face) {
+    int obtuse_index = Custom_CDT::face_record(face).obtuse_vertex;
+    if (obtuse_index < 0) throw logic_error("No obtuse angle found in the triangle.");
+    return obtuse_index;
+}
 
-    Point_2 p1 = face->vertex(0)->point();
-    Point_2 p2 = face->vertex(1)->point();
-    Point_2 p3 = face->vertex(2)->point();
-    //Create segments for each edge of the triangle
-    Segment_2 edge1(p1, p2);
-    Segment_2 edge2(p2, p3);
-    Segment_2 edge3(p3, p1);
-
-    //Compare the squared lengths of the segments to find the longest one
-    auto length1 = CGAL::squared_distance(p1, p2);
-    auto length2 = CGAL::squared_distance(p2, p3);
-    auto length3 = CGAL::squared_distance(p3, p1);
-
-    //Determine which edge is the longest
-    if (length1 >= length2 && length1 >= length3) {
-        return edge1;
-    } else if (length2 >= length1 && length2 >= length3) {
-        return edge2;
-    } else {
-        return edge3;
-    }
+//Find the longest edge of a face, (p1, p2), (p2, p3) or (p3, p1) from the record of the face
+Segment_2 find_longest_edge(const Face_handle& face) {
+    int opposite = Custom_CDT::face_record(face).longest_edge;
+    return Segment_2(face->vertex((opposite + 1) % 3)->point(), face->vertex((opposite + 2) % 3)->point());
 }
 
 void print_polygon_edges(const Polygon& polygon){
@@ -1555,11 +1975,9 @@ bool is_polygon_convex(const set<Point_2>& unique_points) {
     return true;
 }
 
-//Function to check if a vertex in custom_cdt is a Steiner point
-bool is_steiner_point(Vertex_handle vertex, const vector<Point_2>& original_points) {
-    const Point_2& vertex_point = vertex->point();
-    //Check if vertex_point is in the original_points vector
-    return find(original_points.begin(), original_points.end(), vertex_point) == original_points.end();
+//Function to check if a vertex in custom_cdt is a Steiner point, O(1) from the input index that the vertex keeps
+bool is_steiner_point(Vertex_handle vertex) {
+    return Custom_CDT::is_steiner_vertex(vertex);
 }
 
 
@@ -1574,14 +1992,19 @@ void output(value jv, Custom_CDT custom_cdt, vector<Point_2> original_points, in
     //Prepare steiner points lists
     vector<std_string> steiner_points_x;
     vector<std_string> steiner_points_y;
+    //Index of every vertex in the solution: the input points keep their index, the steiner points follow them
+    //in the order of the steiner lists. Indexed by vertex id.
+    vector<int> vertex_index(custom_cdt.vertex_id_bound(), -1);
 
     for (auto vertex = custom_cdt.finite_vertices_begin(); vertex != custom_cdt.finite_vertices_end(); ++vertex){
-        // if a vertex is not found in the initial points then it must be a steiner point
-        if (is_steiner_point(vertex, original_points)){
-            const Point_2& p = vertex->point();
-            steiner_points_x.push_back(convert_to_string(p.x())); //Store x-coordinate as string
-            steiner_points_y.push_back(convert_to_string(p.y())); //Store y-coordinate as string
+        if (!is_steiner_point(vertex)){
+            vertex_index[Custom_CDT::vertex_id(vertex)] = Custom_CDT::input_index(vertex);
+            continue;
         }
+        vertex_index[Custom_CDT::vertex_id(vertex)] = original_points.size() + steiner_points_x.size();
+        const Point_2& p = vertex->point();
+        steiner_points_x.push_back(convert_to_string(p.x())); //Store x-coordinate as string
+        steiner_points_y.push_back(convert_to_string(p.y())); //Store y-coordinate as string
     }
     
     //Convert steiner_points_x and steiner_points_y to JSON-compatible format
@@ -1598,20 +2021,12 @@ void output(value jv, Custom_CDT custom_cdt, vector<Point_2> original_points, in
 
     //Prepare edges list
     vector<pair<int, int>> edges;
-    //vector<Vertex_handle, int> vertex_index_map;
-    std::map<Vertex_handle, int> vertex_index_map;
-    int index = 0;
-
-    //Map vertices to unique indices
-    for (auto vertex = custom_cdt.finite_vertices_begin(); vertex != custom_cdt.finite_vertices_end(); ++vertex){
-        vertex_index_map[vertex] = index++;
-    }
 
     //Collect edges
     for (auto edge = custom_cdt.finite_edges_begin(); edge != custom_cdt.finite_edges_end(); ++edge){
         auto v1 = edge->first->vertex((edge->second + 1) % 3);
         auto v2 = edge->first->vertex((edge->second + 2) % 3);
-        edges.emplace_back(vertex_index_map[v1], vertex_index_map[v2]);
+        edges.emplace_back(vertex_index[Custom_CDT::vertex_id(v1)], vertex_index[Custom_CDT::vertex_id(v2)]);
     }
 
     //Convert to JSON arrays
@@ -1677,6 +2092,15 @@ std_string convert_to_string(const K::FT& coord) {
     return oss.str();
 }
 
+//The inverse of convert_to_string: an integer "n" or a rational "n/d", exact
+FT convert_from_string(const std_string& text) {
+    std::decay_t<decltype(CGAL::exact(FT()))> exact_coord;
+    istringstream iss(text);
+    iss>>exact_coord;
+    if (!iss) throw logic_error("Wrong coordinate: " + text);
+    return FT(exact_coord);
+}
+
 /*3rd Task*/
 bool are_constraints_closed(const vector<pair<int, int>>& additional_constraints, int num_points, 
                             const vector<Point_2>& points, const Polygon& polygon) {
@@ -1775,7 +2199,10 @@ bool boundary_straight_lines(const Polygon& polygon){
 void method_output(const vector<int> count_steiners, std_string method_name, const std_string& name_of_instance, 
                     const int num_steiners, const int init_num_obtuses, const int num_obtuses, bool randomization, 
                     vector<Point_2>& random_steiners, const double rate_of_convergence, double Energy, vector<int> subset,
-                    std_string category){
+                    std_string category, const std_string& chains_summary){
+    //The instances of a batch append to the same file
+    static std::mutex output_mutex;
+    std::lock_guard<std::mutex> lock(output_mutex);
     ofstream outFile("output_simple-polygon-exterior.md", std::ios::app); //Open file for writing
 
     if (!outFile) {
@@ -1806,6 +2233,8 @@ void method_output(const vector<int> count_steiners, std_string method_name, con
     outFile<<endl;
     outFile<<"Rate of convergence: "<<rate_of_convergence<<endl;
     outFile<<"Energy: "<<Energy<<endl;
+    //The result of every chain of a multi chain simulated annealing
+    if(!chains_summary.empty()) outFile<<chains_summary;
 
     outFile<<"Choosing methods: [";
     for (int i = 0; i < subset.size(); ++i) {
@@ -1852,8 +2281,9 @@ double compute_bounding_circle_radius(Face_handle face, const Point_2& centroid)
     return sqrt(min_distance); //Return the actual radius
 }
 
-//Insert steiner point around the centroid with gaussian distribution
-void insert_steiner_around_centroid(Custom_CDT& custom_cdt, Face_handle& face, Polygon& polygon, Point_2& steiner_around_centroid) {
+//Insert steiner point around the centroid with gaussian distribution, the point is drawn from rng
+void insert_steiner_around_centroid(Custom_CDT& custom_cdt, Face_handle& face, Polygon& polygon, Point_2& steiner_around_centroid,
+                                    std::mt19937& rng) {
     double stddev_ratio = 0.33;
     //Compute the centroid of the triangle
     Point_2 centroid = CGAL::centroid(face->vertex(0)->point(), face->vertex(1)->point(), face->vertex(2)->point());
@@ -1864,8 +2294,6 @@ void insert_steiner_around_centroid(Custom_CDT& custom_cdt, Face_handle& face, P
     //Use a fraction of the bounding radius as the standard deviation, determines the spread of the distribution
     double stddev = stddev_ratio * max_distance;
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
     std::normal_distribution<> dist_x(CGAL::to_double(centroid.x()), stddev);
     std::normal_distribution<> dist_y(CGAL::to_double(centroid.y()), stddev);
 
@@ -1874,8 +2302,8 @@ void insert_steiner_around_centroid(Custom_CDT& custom_cdt, Face_handle& face, P
 
     do {
         //Generate a random point around the centroid
-        double random_x = dist_x(gen);
-        double random_y = dist_y(gen);
+        double random_x = dist_x(rng);
+        double random_y = dist_y(rng);
         random_point = Point_2(random_x, random_y);
         steiner_around_centroid = random_point;
         f = custom_cdt.locate(random_point);
@@ -1884,20 +2312,19 @@ void insert_steiner_around_centroid(Custom_CDT& custom_cdt, Face_handle& face, P
     } while (!are_faces_equal(f, face)); //Ensure the point is inside or on the face
 
     if (is_point_inside_region(random_point, polygon)) {
-        custom_cdt.insert_no_flip(random_point);
-        start_the_flips(custom_cdt, polygon);
+        start_the_flips(custom_cdt, polygon, custom_cdt.insert_no_flip(random_point));
     }  
 }
 
-//Try to insert insert_steiner_around_centroid (3rd task)
-void try_steiner_around_centroid(Custom_CDT& best_cdt, Polygon& polygon, Point_2& random_steiner){
-
-    Face_handle random_oobtuse_face = give_random_obtuse(best_cdt, polygon);
+//Try to insert insert_steiner_around_centroid (3rd task). The random choices come from the generator of the caller,
+//so a chain (or a walk) can be repeated from its seed
+void try_steiner_around_centroid(Custom_CDT& best_cdt, Polygon& polygon, Point_2& random_steiner, std::mt19937& rng){
+    Face_handle random_oobtuse_face = give_random_obtuse(best_cdt, polygon, rng);
     /*Point p1 = random_oobtuse_face->vertex(0)->point();
     Point p2 = random_oobtuse_face->vertex(1)->point();
     Point p3 = random_oobtuse_face->vertex(2)->point();*/
     Point_2 steiner_temp;
-    insert_steiner_around_centroid(best_cdt, random_oobtuse_face, polygon, steiner_temp);
+    insert_steiner_around_centroid(best_cdt, random_oobtuse_face, polygon, steiner_temp, rng);
     random_steiner = steiner_temp;
 }
 
@@ -6,7 +6,7 @@ using namespace std;
 using K = CGAL::Exact_predicates_exact_constructions_kernel;
 using CDT = CGAL::Constrained_Delaunay_triangulation_2<K>;
 using Point = CDT::Point;
-typedef CGAL::Polygon_2<K> Polygon;
+typedef Custom_Polygon_2<K> Polygon;
 using Custom_CDT = Custom_Constrained_Delaunay_triangulation_2<K>;
 using Point_2 = K::Point_2;
 using Line_2 = K::Line_2;
@@ -22,14 +22,14 @@ double squared_distance_1(const Point_2 &a, const Point_2 &b)
 
 bool is_obtuse(const Point_2 &a, const Point_2 &b, const Point_2 &c)
 {
-    return (CGAL::angle(a, b, c) == CGAL::OBTUSE ||
-            CGAL::angle(b, a, c) == CGAL::OBTUSE ||
-            CGAL::angle(a, c, b) == CGAL::OBTUSE);
+    return filtered_is_obtuse(a, b, c);
 }
 
-//Just count the number of obtuses triangles in a cdt
-int count_obtuse_triangles_1(CDT &cdt, const Polygon &polygon)
+//Just count the number of obtuses triangles in a cdt (O(1) when the Custom CDT knows the region)
+int count_obtuse_triangles_1(const Custom_CDT &cdt, const Polygon &polygon)
 {
+    if (cdt.has_region())
+        return cdt.number_of_obtuse_faces();
     int obtuse_count = 0;
     for (auto fit = cdt.finite_faces_begin(); fit != cdt.finite_faces_end(); ++fit)
     {
@@ -60,46 +60,31 @@ bool is_convex_1(const Point_2 &p1, const Point_2 &p2, const Point_2 &p3, const
 // Return true if approves the flip
 bool can_flip(const Point_2 &p1, const Point_2 &p2, const Point_2 &p3, const Point_2 &p4)
 {
-    // Check if the quadrilateral (p2, p4, p3, p1) is convex
-    if (is_convex_1(p1, p2, p3, p4))
-    {
-        // Count obtuse angles before the flip
-        int obtuse_before_cnt = 0;
-        if (is_obtuse(p1, p2, p3))
-            obtuse_before_cnt++;
-        if (is_obtuse(p1, p3, p4))
-            obtuse_before_cnt++;
-
-        // Count obtuse angles after the potential flip
-        int obtuse_after_cnt = 0;
-        if (is_obtuse(p1, p2, p4))
-            obtuse_after_cnt++;
-        if (is_obtuse(p2, p3, p4))
-            obtuse_after_cnt++;
-
-        // Check collinearity of all possible triplets among p1, p2, p3, p4
-        if (CGAL::orientation(p1, p2, p3) == CGAL::COLLINEAR ||
-            CGAL::orientation(p1, p2, p4) == CGAL::COLLINEAR ||
-            CGAL::orientation(p1, p3, p4) == CGAL::COLLINEAR ||
-            CGAL::orientation(p2, p3, p4) == CGAL::COLLINEAR)
-        {
-            // Skip the flip if any three points are collinear
-            return false;
-        }
+    // The quadrilateral (p1, p2, p3, p4) must be convex and skip the flip if any three points are collinear
+    if (!filtered_is_strictly_convex(p1, p2, p3, p4))
+        return false;
 
-        // If its worth flipping, do it!
-        if (obtuse_after_cnt < obtuse_before_cnt)
-            return true;
-        else
-            return false;
-    }
-    // Case quadrilateral is not convex
-    return false;
+    // Count obtuse angles before the flip
+    int obtuse_before_cnt = 0;
+    if (is_obtuse(p1, p2, p3))
+        obtuse_before_cnt++;
+    if (is_obtuse(p1, p3, p4))
+        obtuse_before_cnt++;
+
+    // Count obtuse angles after the potential flip
+    int obtuse_after_cnt = 0;
+    if (is_obtuse(p1, p2, p4))
+        obtuse_after_cnt++;
+    if (is_obtuse(p2, p3, p4))
+        obtuse_after_cnt++;
+
+    // If its worth flipping, do it!
+    return obtuse_after_cnt < obtuse_before_cnt;
 }
 
 // Midpoint Insertion:
 // Finds the longest edge of the obtuse triangle and calculates its midpoint.
-// Simulates inserting the midpoint to see if it reduces obtuse angles. If successful, inserts it into the actual CDT.
+// Simulates inserting the midpoint (in a transaction) to see if it reduces obtuse angles. If successful, keeps it into the actual CDT.
 void insert_midpoint_1(Custom_CDT &custom_cdt, Polygon &polygon)
 {
     bool progress = true;
@@ -108,25 +93,28 @@ void insert_midpoint_1(Custom_CDT &custom_cdt, Polygon &polygon)
         progress = false;
         for (auto face = custom_cdt.finite_faces_begin(); face != custom_cdt.finite_faces_end(); ++face)
         {
+            //Stopped: every committed insertion reduced the obtuses, the current triangulation is the best
+            if (search_should_stop()) return;
             Point_2 p1 = face->vertex(0)->point();
             Point_2 p2 = face->vertex(1)->point();
             Point_2 p3 = face->vertex(2)->point();
 
             if (is_obtuse(p1, p2, p3))
             {
-                Custom_CDT simulation = custom_cdt;
                 CGAL::Segment_2 longest_edge = find_longest_edge(p1, p2, p3);
                 Point_2 midpoint = CGAL::midpoint(longest_edge.source(), longest_edge.target());
 
-                if (is_point_inside_region(midpoint, polygon) && is_face_inside_region_1(face, polygon))
+                if (is_point_inside_region(midpoint, polygon) && is_face_inside_region_1(face))
                 {
-                    int obtuses_before = count_obtuse_triangles_1(simulation, polygon);
-                    simulation.insert_no_flip(midpoint);
-                    start_the_flips_1(simulation, polygon);
-                    if (obtuses_before > count_obtuse_triangles_1(simulation, polygon))
+                    int obtuses_before = count_obtuse_triangles_1(custom_cdt, polygon);
+                    custom_cdt.begin_transaction();
+                    start_the_flips_1(custom_cdt, custom_cdt.insert_no_flip(midpoint));
+                    if (obtuses_before <= count_obtuse_triangles_1(custom_cdt, polygon))
+                        custom_cdt.rollback_transaction();
+                    else
                     {
-                        custom_cdt.insert_no_flip(midpoint);
-                        start_the_flips_1(custom_cdt, polygon);
+                        //The simulation is the original insertion, keep it
+                        custom_cdt.commit_transaction();
                         progress = true;
                         if((polygon.bounded_side(midpoint) == CGAL::ON_BOUNDARY))
                                 update_polygon_1(polygon, midpoint, longest_edge.source(), longest_edge.target());
@@ -148,6 +136,7 @@ void insert_orthocenter_1(Custom_CDT &custom_cdt, const Polygon &polygon)
         progress = false;
         for (auto face = custom_cdt.finite_faces_begin(); face != custom_cdt.finite_faces_end(); ++face)
         {
+            if (search_should_stop()) return;
             Point_2 p1 = face->vertex(0)->point();
             Point_2 p2 = face->vertex(1)->point();
             Point_2 p3 = face->vertex(2)->point();
@@ -155,24 +144,24 @@ void insert_orthocenter_1(Custom_CDT &custom_cdt, const Polygon &polygon)
             //Check if the triangle is obtuse
             if (is_obtuse(p1, p2, p3))
             {
-                Custom_CDT simulation = custom_cdt;
                 Point_2 obtuse_vertex = find_obtuse_vertex_1(p1, p2, p3);
 
                 //Calculate the orthocenter of the obtuse triangle
                 Point_2 orthocenter = find_orthocenter(p1, p2, p3);
 
                 //Verify if the orthocenter point can be inserted
-                if (is_point_inside_region(orthocenter, polygon) && is_face_inside_region_1(face, polygon))
+                if (is_point_inside_region(orthocenter, polygon) && is_face_inside_region_1(face))
                 {
-                    int obtuses_before = count_obtuse_triangles_1(simulation, polygon);
-                    simulation.insert_no_flip(orthocenter);
-                    start_the_flips_1(simulation, polygon);
+                    int obtuses_before = count_obtuse_triangles_1(custom_cdt, polygon);
+                    custom_cdt.begin_transaction();
+                    start_the_flips_1(custom_cdt, custom_cdt.insert_no_flip(orthocenter));
 
                     //Check if insertion of orthocenter reduces obtuse triangles
-                    if (obtuses_before > count_obtuse_triangles_1(simulation, polygon))
+                    if (obtuses_before <= count_obtuse_triangles_1(custom_cdt, polygon))
+                        custom_cdt.rollback_transaction();
+                    else
                     {
-                        custom_cdt.insert_no_flip(orthocenter);
-                        start_the_flips_1(custom_cdt, polygon);
+                        custom_cdt.commit_transaction();
                         progress = true;
                         break;
                     }
@@ -197,6 +186,7 @@ void insert_projection_1(Custom_CDT &custom_cdt, Polygon& polygon)
             progress = false;
         for (auto face = custom_cdt.finite_faces_begin(); face != custom_cdt.finite_faces_end(); ++face)
         {
+            if (search_should_stop()) return;
             Point_2 p1 = face->vertex(0)->point();
             Point_2 p2 = face->vertex(1)->point();
             Point_2 p3 = face->vertex(2)->point();
@@ -224,23 +214,23 @@ void insert_projection_1(Custom_CDT &custom_cdt, Polygon& polygon)
                 }
                 Line_2 line(opposite1, opposite2);
                 Point_2 projected_point = line.projection(obtuse_angle_vertex);
-                //Copy the cdt for simulation
-                Custom_CDT simulation = custom_cdt;
+                //The simulations run in a transaction of the cdt
                 bool insert_projection = is_point_inside_region(projected_point, polygon);
 
-                int obtuses_before = count_obtuse_triangles_1(simulation, polygon);
+                int obtuses_before = count_obtuse_triangles_1(custom_cdt, polygon);
                 //Itarate all the faces of the boundary. If the point in side (not on) of the boundary is obtuse, insert projection
-                if (fill_boundary && insert_projection && is_face_inside_region_1(face, polygon))
+                if (fill_boundary && insert_projection && is_face_inside_region_1(face))
                 {
                     if (is_face_on_boundary(custom_cdt, face) && !(polygon.bounded_side(obtuse_angle_vertex) == CGAL::ON_BOUNDARY))
                     {
-                        simulation.insert_no_flip(projected_point);
-                        start_the_flips_1(simulation, polygon);
-                        if (obtuses_before > count_obtuse_triangles_1(simulation, polygon))
+                        custom_cdt.begin_transaction();
+                        start_the_flips_1(custom_cdt, custom_cdt.insert_no_flip(projected_point));
+                        if (obtuses_before <= count_obtuse_triangles_1(custom_cdt, polygon))
+                            custom_cdt.rollback_transaction();
+                        else
                         {
-                            /*Original insertion of Projection*/
-                            custom_cdt.insert_no_flip(projected_point);
-                            start_the_flips_1(custom_cdt, polygon);
+                            /*Original insertion of Projection is the simulation*/
+                            custom_cdt.commit_transaction();
                             if((polygon.bounded_side(projected_point) == CGAL::ON_BOUNDARY))
                                 update_polygon_1(polygon, projected_point, opposite2, opposite1);
                             
@@ -250,53 +240,56 @@ void insert_projection_1(Custom_CDT &custom_cdt, Polygon& polygon)
                 //main case, not only the boundary faces
                 else if (insert_projection)
                 {
-                    simulation.insert(projected_point);
-                    start_the_flips_1(simulation, polygon);
-
-                    if (obtuses_before > count_obtuse_triangles_1(simulation, polygon))
-                    {
-                        /*Original insertion of Projection*/
-                        custom_cdt.insert_no_flip(projected_point);
-                        start_the_flips_1(custom_cdt, polygon);
-                        progress = true;
-                        if((polygon.bounded_side(projected_point) == CGAL::ON_BOUNDARY))
-                                update_polygon_1(polygon, projected_point, opposite2, opposite1);
-                        break;
-                    }
+                    custom_cdt.begin_transaction();
+                    start_the_flips_1(custom_cdt, custom_cdt.insert(projected_point));
+                    int obtuses_after = count_obtuse_triangles_1(custom_cdt, polygon);
+                    bool on_obtuse_boundary_face = false;
                     // Case the projection point reduce -1 the obtuse angle, but make new obtuse angle in the neighbor
                     // If this neighbor is boundary face (at least 2 points lies in the boundary polygon) and the projection point
                     // is part of this face but is in (not on) the boundary, add the projection
-                    else if (obtuses_before == count_obtuse_triangles_1(simulation, polygon))
+                    if (obtuses_before == obtuses_after)
                     {
-
-                        for (auto sim_face = simulation.finite_faces_begin(); sim_face != simulation.finite_faces_end(); ++sim_face)
+                        for (auto sim_face = custom_cdt.finite_faces_begin(); sim_face != custom_cdt.finite_faces_end(); ++sim_face)
                         {
-                            if (simulation.is_infinite(sim_face))
-                                continue;
-
                             // Check if the projected point is part of a boundary face
                             if (sim_face->vertex(0)->point() == projected_point ||
                                 sim_face->vertex(1)->point() == projected_point ||
                                 sim_face->vertex(2)->point() == projected_point)
                             {
-                                if (is_face_on_boundary(simulation, sim_face))
+                                if (is_face_on_boundary(custom_cdt, sim_face) &&
+                                    is_obtuse(sim_face->vertex(0)->point(), sim_face->vertex(1)->point(), sim_face->vertex(2)->point()))
                                 {
-                                    if (is_obtuse(sim_face->vertex(0)->point(), sim_face->vertex(1)->point(), sim_face->vertex(2)->point()))
-                                    {
-                                        // Insert into the original triangulation
-                                        custom_cdt.insert_no_flip(projected_point);
-                                        start_the_flips_1(custom_cdt, polygon);
-                                        progress = true;
-                                        //"call" the fill boundary case
-                                        fill_boundary = true;
-                                        if((polygon.bounded_side(projected_point) == CGAL::ON_BOUNDARY))
-                                            update_polygon_1(polygon, projected_point, opposite2, opposite1);
-                                        break;
-                                    }
+                                    on_obtuse_boundary_face = true;
+                                    break;
                                 }
                             }
                         }
                     }
+                    //The simulation inserts with delaunay flips, the original insertion without, so take back the simulation
+                    custom_cdt.rollback_transaction();
+
+                    if (obtuses_before > obtuses_after)
+                    {
+                        /*Original insertion of Projection*/
+                        start_the_flips_1(custom_cdt, custom_cdt.insert_no_flip(projected_point));
+                        progress = true;
+                        if((polygon.bounded_side(projected_point) == CGAL::ON_BOUNDARY))
+                                update_polygon_1(polygon, projected_point, opposite2, opposite1);
+                        break;
+                    }
+                    // Case the projection point reduce -1 the obtuse angle, but make new obtuse angle in the neighbor
+                    // If this neighbor is boundary face (at least 2 points lies in the boundary polygon) and the projection point
+                    // is part of this face but is in (not on) the boundary, add the projection
+                    else if (on_obtuse_boundary_face)
+                    {
+                        // Insert into the original triangulation
+                        start_the_flips_1(custom_cdt, custom_cdt.insert_no_flip(projected_point));
+                        progress = true;
+                        //"call" the fill boundary case
+                        fill_boundary = true;
+                        if((polygon.bounded_side(projected_point) == CGAL::ON_BOUNDARY))
+                            update_polygon_1(polygon, projected_point, opposite2, opposite1);
+                    }
                 }
             }
             //when the case of itaration of boundary faces ends
@@ -316,18 +309,11 @@ void insert_projection_1(Custom_CDT &custom_cdt, Polygon& polygon)
     }
 }
 
-//Function to check if an edge is part of the boundary of the polygon
-bool is_edge_on_boundary_1(const Point_2 &p1, const Point_2 &p2, const Polygon &polygon)
+//Function to check if an edge is part of the boundary of the polygon, O(1) from the constraint and domain
+//marks of the cdt
+bool is_edge_on_boundary_1(const Custom_CDT &custom_cdt, const Face_handle &face, int i)
 {
-    for (auto edge_it = polygon.edges_begin(); edge_it != polygon.edges_end(); ++edge_it)
-    {
-        if ((edge_it->source() == p1 && edge_it->target() == p2) ||
-            (edge_it->source() == p2 && edge_it->target() == p1))
-        {
-            return true;
-        }
-    }
-    return false;
+    return custom_cdt.is_boundary_edge(face, i);
 }
 
 //Ιnsert Steiner points at circumcenters
@@ -339,6 +325,7 @@ void insert_circumcenter_centroid_1(Custom_CDT &custom_cdt, const Polygon &polyg
         progress = false;
         for (auto face = custom_cdt.finite_faces_begin(); face != custom_cdt.finite_faces_end(); ++face)
         {
+            if (search_should_stop()) return;
             //Get the vertices of the current triangle
             Point_2 p1 = face->vertex(0)->point();
             Point_2 p2 = face->vertex(1)->point();
@@ -351,21 +338,21 @@ void insert_circumcenter_centroid_1(Custom_CDT &custom_cdt, const Polygon &polyg
                 Point circumcenter = CGAL::circumcenter(p1, p2, p3);
                 if (is_point_inside_region(circumcenter, polygon))
                 {
-                    Custom_CDT simulation = custom_cdt;
-                    Face_handle locate_face = simulation.locate(circumcenter);
-                    if (is_convex_1(p1, p2, p3, circumcenter) && is_face_inside_region_1(locate_face, polygon))
+                    Face_handle locate_face = custom_cdt.locate(circumcenter);
+                    if (is_convex_1(p1, p2, p3, circumcenter) && is_face_inside_region_1(locate_face))
                     {
                         int initial_obtuse_count = count_obtuse_triangles_1(custom_cdt, polygon);
                         /*Simulate circumcenter insertion*/
-                        simulation.insert_no_flip(circumcenter);
-                        start_the_flips_1(simulation, polygon);
-                        int final_obtuse_count = count_obtuse_triangles_1(simulation, polygon);
+                        custom_cdt.begin_transaction();
+                        start_the_flips_1(custom_cdt, custom_cdt.insert_no_flip(circumcenter));
+                        int final_obtuse_count = count_obtuse_triangles_1(custom_cdt, polygon);
                         //Check if the flip resolved obtuse angles in the two faces
-                        if (final_obtuse_count < initial_obtuse_count)
+                        if (final_obtuse_count >= initial_obtuse_count)
+                            custom_cdt.rollback_transaction();
+                        else
                         {
-                            /*Original circumcenter insertion*/
-                            custom_cdt.insert_no_flip(circumcenter);
-                            start_the_flips_1(custom_cdt, polygon);
+                            /*Original circumcenter insertion is the simulation*/
+                            custom_cdt.commit_transaction();
                             progress = true;
                             final_obtuse_count = count_obtuse_triangles_1(custom_cdt, polygon);
                             break;
@@ -378,10 +365,9 @@ void insert_circumcenter_centroid_1(Custom_CDT &custom_cdt, const Polygon &polyg
                     Point_2 centroid = CGAL::centroid(p1, p2, p3);
                     bool insert_centroid = can_insert_centroid(custom_cdt, triangleA, centroid, polygon);
                     //Just check if the insertion of centroid has a benefit
-                    if (insert_centroid && is_face_inside_region_1(face, polygon))
+                    if (insert_centroid && is_face_inside_region_1(face))
                     {
-                        custom_cdt.insert(centroid);
-                        start_the_flips_1(custom_cdt, polygon);
+                        start_the_flips_1(custom_cdt, custom_cdt.insert(centroid));
                         progress = true;
                         break;
                     }
@@ -394,7 +380,6 @@ void insert_circumcenter_centroid_1(Custom_CDT &custom_cdt, const Polygon &polyg
 //Just simulate if insert centroid (and auto flips) we reduce the obtuses
 bool can_insert_centroid(Custom_CDT &custom_cdt, Face_handle &triangleA, const Point_2 &centroid, const Polygon &polygon)
 {
-    Custom_CDT simulation = custom_cdt;
     //Get the vertices of triangle A
     Point_2 p1 = triangleA->vertex(0)->point();
     Point_2 p2 = triangleA->vertex(1)->point();
@@ -402,9 +387,10 @@ bool can_insert_centroid(Custom_CDT &custom_cdt, Face_handle &triangleA, const P
 
     int initial_obtuse_count = count_obtuse_triangles_1(custom_cdt, polygon);
     /*Simulate centroid insertion*/
-    simulation.insert(centroid);
-    start_the_flips_1(simulation, polygon);
-    int final_obtuse_count = count_obtuse_triangles_1(simulation, polygon);
+    custom_cdt.begin_transaction();
+    start_the_flips_1(custom_cdt, custom_cdt.insert(centroid));
+    int final_obtuse_count = count_obtuse_triangles_1(custom_cdt, polygon);
+    custom_cdt.rollback_transaction();
 
     //Check if the number of obtuse triangles decreased or stayed the same
     if (final_obtuse_count < initial_obtuse_count)
@@ -413,42 +399,11 @@ bool can_insert_centroid(Custom_CDT &custom_cdt, Face_handle &triangleA, const P
         return false;
 }
 
-void start_the_flips_1(Custom_CDT &cdt, const Polygon &polygon)
+//Flips with the worklist flip engine of the Custom CDT, seeded with the edges around seed (every edge if null)
+Flip_stats start_the_flips_1(Custom_CDT &cdt, Vertex_handle seed)
 {
-    bool progress = true;
-    while (progress)
-    {
-        progress = false;
-        for (auto edge = cdt.finite_edges_begin(); edge != cdt.finite_edges_end(); ++edge)
-        {
-            CDT::Face_handle f1 = edge->first;
-            int i = edge->second;
-            CDT::Face_handle f2 = f1->neighbor(i);
-
-            if (cdt.is_infinite(f1) || cdt.is_infinite(f2))
-                continue;
-
-            Point_2 p1 = f1->vertex(cdt.ccw(i))->point(); // First vertex on the shared edge (Counter-Clock Wise)
-            Point_2 p3 = f1->vertex(cdt.cw(i))->point();  // Second vertex on the shared edge (Clock Wise)
-            Point_2 p2 = f1->vertex(i)->point();          // Opposite vertex in the first triangle
-            //Mirror index gets the opposite vertex of the second triangle (f2)
-            int mirror_index = cdt.mirror_index(f1, i);
-            Point_2 p4 = f2->vertex(mirror_index)->point();
-            //if the eddge is constraints or is on
-            if (cdt.is_constrained(*edge) || is_edge_on_boundary_1(p1, p3, polygon))
-                continue;
-            
-            if(!is_face_inside_region_1(f1, polygon) || !is_face_inside_region_1(f2, polygon)) continue;
-            if (can_flip(p1, p2, p3, p4))
-            {
-                cdt.flip(f1, i);
-                progress = true;
-                break;
-            }
-            else
-                continue;
-        }
-    }
+    //The engine never offers a constrained edge, so never a boundary edge (the boundary is inserted as constraints)
+    return cdt.flip_edges(seed, can_flip);
 }
 
 //If 1 point is on the boundary
@@ -456,22 +411,22 @@ bool is_point_inside_region(const Point_2 &point, const Polygon polygon)
 {
 
     //Check if the point is inside the polygon
-    return (polygon.bounded_side(point) == CGAL::ON_BOUNDED_SIDE) || (polygon.bounded_side(point) == CGAL::ON_BOUNDARY);
+    return polygon.bounded_side(point) != CGAL::ON_UNBOUNDED_SIDE;
 }
 
 Point_2 find_obtuse_vertex_1(const Point_2 &v1, const Point_2 &v2, const Point_2 &v3)
 {
-    //Calculate squared distances
-    double ab2 = CGAL::to_double(squared_distance_1(v1, v2));
-    double ac2 = CGAL::to_double(squared_distance_1(v1, v3));
-    double bc2 = CGAL::to_double(squared_distance_1(v2, v3));
-
-    if (ab2 + ac2 < bc2)
+    switch (filtered_obtuse_vertex(v1, v2, v3))
+    {
+    case 0:
         return v1; //obtuse angle at v1
-    if (ab2 + bc2 < ac2)
+    case 1:
         return v2; //obtuse angle at v2
-    if (ac2 + bc2 < ab2)
+    case 2:
         return v3; //obtuse angle at v3
+    default:
+        break;
+    }
 
     throw std::logic_error("No obtuse angle found in the triangle.");
 }
@@ -571,38 +526,38 @@ void run_task1(Custom_CDT& custom_cdt, Polygon& polygon){
     int end;
     //If we have progress (reduce obtuses) run again
     bool progress = true;
-    while(progress){
+    while(progress && !search_should_stop()){
         progress = false;
         int start = count_obtuse_triangles_1(custom_cdt, polygon);
         int num_obtuses_before = start;
         //Flips
-        start_the_flips_1(custom_cdt, polygon);
+        start_the_flips_1(custom_cdt);
         int num_obtuses_after = count_obtuse_triangles_1(custom_cdt, polygon);
-        if(num_obtuses_after == 0) break;
+        if(num_obtuses_after == 0 || search_should_stop()) break;
 
         //Circumcenter - Centroid
         num_obtuses_before = count_obtuse_triangles_1(custom_cdt, polygon);
         insert_circumcenter_centroid_1(custom_cdt, polygon);
         num_obtuses_after = count_obtuse_triangles_1(custom_cdt, polygon);
-        if(num_obtuses_after == 0) break;
+        if(num_obtuses_after == 0 || search_should_stop()) break;
 
         //Midpoint
         num_obtuses_before = count_obtuse_triangles_1(custom_cdt, polygon);
         insert_midpoint_1(custom_cdt, polygon);
         num_obtuses_after = count_obtuse_triangles_1(custom_cdt, polygon);
-        if(num_obtuses_after == 0) break;
+        if(num_obtuses_after == 0 || search_should_stop()) break;
 
         //Projection
         num_obtuses_before = count_obtuse_triangles_1(custom_cdt, polygon);
         insert_projection_1(custom_cdt, polygon);
         num_obtuses_after = count_obtuse_triangles_1(custom_cdt, polygon);
-        if(num_obtuses_after == 0) break;
+        if(num_obtuses_after == 0 || search_should_stop()) break;
         
         //Orthocenter
         num_obtuses_before = count_obtuse_triangles_1(custom_cdt, polygon);
         insert_orthocenter_1(custom_cdt, polygon);
         num_obtuses_after = count_obtuse_triangles_1(custom_cdt, polygon);
-        if(num_obtuses_after == 0) break;
+        if(num_obtuses_after == 0 || search_should_stop()) break;
         
         end = num_obtuses_after;
         if(end < start ) progress = true;
@@ -611,53 +566,9 @@ void run_task1(Custom_CDT& custom_cdt, Polygon& polygon){
     }
 }
 
-//If face is inside of region boundary
-bool is_face_inside_region_1(const Face_handle& face, const Polygon& polygon) {
-    Point_2 p1 = face->vertex(0)->point();
-    Point_2 p2 = face->vertex(1)->point();
-    Point_2 p3 = face->vertex(2)->point(); 
-
-    //Check if vertices are inside or on the boundary of the polygon
-    bool vertices_inside = 
-        (polygon.bounded_side(p1) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(p1) == CGAL::ON_BOUNDARY) &&
-        (polygon.bounded_side(p2) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(p2) == CGAL::ON_BOUNDARY) &&
-        (polygon.bounded_side(p3) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(p3) == CGAL::ON_BOUNDARY);
-
-    if (!vertices_inside) return false;
-
-    //Check if edges are fully inside or on the boundary
-    bool edges_inside = 
-        (polygon.bounded_side(CGAL::midpoint(p1, p2)) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(CGAL::midpoint(p1, p2)) == CGAL::ON_BOUNDARY) &&
-        (polygon.bounded_side(CGAL::midpoint(p1, p3)) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(CGAL::midpoint(p1, p3)) == CGAL::ON_BOUNDARY) &&
-        (polygon.bounded_side(CGAL::midpoint(p2, p3)) == CGAL::ON_BOUNDED_SIDE || polygon.bounded_side(CGAL::midpoint(p2, p3)) == CGAL::ON_BOUNDARY);
-    
-    if (!edges_inside) return false;
-
-    //The lines of the face
-    Segment_2 line1(p1, p2), line2(p1, p3), line3(p2, p3);
-    //bool edge_intersects_boundary = true;
-    //For every edge of the polygon (boundary)
-    for (auto edge = polygon.edges_begin(); edge != polygon.edges_end(); ++edge) {
-        //if(!edge_intersects_boundary) break;
-        Segment_2 poly_edge(*edge);
-        //Check intersections for each face edge
-        vector<Segment_2> face_edges = {line1, line2, line3};
-        //Check every line of the face if it has intersection with the curent polygon edge
-        for (const auto& face_edge : face_edges) {
-            auto result = CGAL::intersection(face_edge, poly_edge);
-            //If we have intersection between edge face and edge polygon (curent)
-            if (result) {
-                //Check if the intersection return point (not segment, line etc)
-                if (const Point_2* point = boost::get<Point_2>(&*result)) {
-                    //Check also for clean intersection, not intersection like the polygon edge intersect vertex of face
-                    if ((*point != face_edge.source()) && (*point != face_edge.target()) && face_edge.has_on(*point)){
-                        return false;
-                    }
-                }
-            }
-        }
-    }
-    return true;
+//If face is inside of region boundary (domain mark of the Custom CDT, O(1))
+bool is_face_inside_region_1(const Face_handle& face) {
+    return Custom_CDT::is_in_domain(face);
 }
 
 void update_polygon_1(Polygon& polygon, const Point_2& steiner_point, const Point_2& p1, const Point_2& p2) {
@@ -5,22 +5,123 @@
 
 
 #include <CGAL/Constrained_Delaunay_triangulation_2.h>
+#include <CGAL/Constrained_triangulation_face_base_2.h>
+#include <CGAL/Triangulation_face_base_with_info_2.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+#include <CGAL/Triangulation_data_structure_2.h>
+#include <CGAL/Polygon_2.h>
+#include "filtered_predicates.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <random>
+#include <memory>
+#include <set>
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
 
 
 
-template <class Gt, class Tds = CGAL::Default, class Itag = CGAL::Default>
+//Facts about a face that the Steiner methods and the ants ask for again and again. They are computed when the
+//face is created or rebuilt by an insertion, a flip or an undo, so reading them never writes to the face.
+struct Custom_face_record {
+    //Index of the obtuse vertex, -1 if the face has no obtuse angle
+    int obtuse_vertex = -1;
+    //Index of the vertex opposite to the longest edge
+    int longest_edge = 0;
+    //Circumradius over the height on the longest edge
+    double rho = 0.0;
+};
+
+
+
+//Bookkeeping that the Custom CDT keeps in every face
+struct Custom_face_info {
+    //True while this face is counted in the running number of obtuse faces
+    bool counted_obtuse = false;
+    //Position of the face in the list of the counted obtuse faces, -1 if it is not counted
+    int obtuse_slot = -1;
+    //True if the face is inside the domain (not reachable from the infinite face without crossing a constraint)
+    bool in_domain = false;
+    //Classification of the face, set by face_created
+    Custom_face_record record;
+};
+
+
+
+//Bookkeeping that the Custom CDT keeps in every vertex
+struct Custom_vertex_info {
+    //Id of the vertex: given when the vertex is created and copied with the triangulation. It is unique among the
+    //live vertices, a rollback gives back the ids of the vertices it removes and the next insertions take them again,
+    //so an id (or a face key) is only valid while no rollback removes its vertex. The ids of the live vertices
+    //follow the creation order, so for the Steiner points it is their sequence number.
+    int id = -1;
+    //Index of the point in the input of the instance, -1 for a Steiner point
+    int input_index = -1;
+};
+
+
+
+//Identity of a face that survives copies of the triangulation: the ids of its vertices, sorted
+using Custom_face_key = std::array<int, 3>;
+
+struct Custom_face_key_hash {
+    std::size_t operator()(const Custom_face_key& key) const {
+        std::size_t h = std::hash<int>()(key[0]);
+        h = h * 1000003u ^ std::hash<int>()(key[1]);
+        return h * 1000003u ^ std::hash<int>()(key[2]);
+    }
+};
+
+using Custom_face_key_set = std::unordered_set<Custom_face_key, Custom_face_key_hash>;
+
+
+
+//Counters of the worklist flip engine
+struct Flip_stats {
+    //Edges that reached the flip rule
+    long long attempted = 0;
+    //Edges that were flipped
+    long long applied = 0;
+};
+
+
+
+//Default data structure of the Custom CDT: the CGAL one, with Custom_vertex_info in the vertices and
+//Custom_face_info in the faces
+template <class Gt>
+struct Custom_cdt_default_tds {
+    typedef CGAL::Triangulation_vertex_base_with_info_2<Custom_vertex_info, Gt> Vb;
+    typedef CGAL::Triangulation_face_base_with_info_2<Custom_face_info, Gt> Fbb;
+    typedef CGAL::Constrained_triangulation_face_base_2<Gt, Fbb> Fb;
+    typedef CGAL::Triangulation_data_structure_2<Vb, Fb> type;
+};
+
+
+
+template <class Gt, class Tds_ = CGAL::Default, class Itag = CGAL::Default>
 
 class Custom_Constrained_Delaunay_triangulation_2
 
-    : public CGAL::Constrained_Delaunay_triangulation_2<Gt, Tds, Itag> {
+    : public CGAL::Constrained_Delaunay_triangulation_2<Gt,
+        typename CGAL::Default::Get<Tds_, typename Custom_cdt_default_tds<Gt>::type>::type, Itag> {
 
 public:
 
+    using Tds = typename CGAL::Default::Get<Tds_, typename Custom_cdt_default_tds<Gt>::type>::type;
     using Base = CGAL::Constrained_Delaunay_triangulation_2<Gt, Tds, Itag>;
     using typename Base::Face_handle;
     using typename Base::Point;
     using typename Base::Vertex_handle;
     using typename Base::Locate_type;
+    using typename Base::Face_circulator;
+    using typename Base::Edge;
+    using Polygon = CGAL::Polygon_2<Gt>;
 
     //Constructors
 
@@ -32,7 +133,7 @@ public:
 
     Custom_Constrained_Delaunay_triangulation_2(typename Base::List_constraints& lc, const Gt& gt = Gt())
 
-        : Base(lc, gt) {}
+        : Base(lc, gt) { recount_obtuse_faces(); }
 
 
 
@@ -40,7 +141,364 @@ public:
 
     Custom_Constrained_Delaunay_triangulation_2(InputIterator it, InputIterator last, const Gt& gt = Gt())
 
-        : Base(it, last, gt) {}
+        : Base(it, last, gt) { recount_obtuse_faces(); }
+
+
+
+    //Copies take the triangulation and the bookkeeping, not the undo log (its handles point into the original)
+    Custom_Constrained_Delaunay_triangulation_2(const Custom_Constrained_Delaunay_triangulation_2& other)
+
+        : Base(other), region(other.region), obtuse_count(other.obtuse_count), total_flips(other.total_flips),
+
+          next_vertex_id(other.next_vertex_id) { rebuild_obtuse_face_list(); }
+
+
+
+    Custom_Constrained_Delaunay_triangulation_2& operator=(const Custom_Constrained_Delaunay_triangulation_2& other) {
+
+        if (this == &other) return *this;
+
+        Base::operator=(other);
+
+        region = other.region;
+
+        obtuse_count = other.obtuse_count;
+
+        total_flips = other.total_flips;
+
+        next_vertex_id = other.next_vertex_id;
+
+        rebuild_obtuse_face_list();
+
+        undo_log.clear();
+
+        transaction_marks.clear();
+
+        return *this;
+
+    }
+
+    //Make this triangulation a copy of other, a Custom CDT of another kernel (the double mirror of an exact one):
+
+    //the same faces, constraints and vertex ids, the points converted with convert. region_polygon is the region
+
+    //of the copy (the converted region of other)
+
+    template <class Other, class Convert>
+
+    void copy_from(const Other& other, Convert convert, const Polygon& region_polygon) {
+
+        using Other_tds = typename Other::Triangulation_data_structure;
+
+        struct Vertex_converter {
+
+            Convert& convert;
+
+            typename Tds::Vertex operator()(const typename Other_tds::Vertex& source) const {
+
+                typename Tds::Vertex vertex;
+
+                vertex.set_point(convert(source.point()));
+
+                vertex.info() = source.info();
+
+                return vertex;
+
+            }
+
+            void operator()(const typename Other_tds::Vertex&, Vertex_handle) const {}
+
+        };
+
+        struct Face_converter {
+
+            typename Tds::Face operator()(const typename Other_tds::Face& source) const {
+
+                typename Tds::Face face;
+
+                for (int i = 0; i < 3; ++i) face.set_constraint(i, source.is_constrained(i));
+
+                return face;
+
+            }
+
+            void operator()(const typename Other_tds::Face&, Face_handle) const {}
+
+        };
+
+        undo_log.clear();
+
+        transaction_marks.clear();
+
+        this->clear();
+
+        Vertex_handle infinite = this->tds().copy_tds(other.tds(), other.infinite_vertex(), Vertex_converter{convert},
+
+                                                      Face_converter());
+
+        this->set_infinite_vertex(infinite);
+
+        next_vertex_id = other.vertex_id_bound();
+
+        total_flips = Flip_stats();
+
+        region = std::make_shared<const Polygon>(region_polygon);
+
+        recount_obtuse_faces();
+
+    }
+
+
+
+    //Region boundary, it must already be inserted as constraints. Only the faces inside of it are counted
+    //as obtuse faces, membership is the in_domain flag. Without a region every finite face is counted.
+    void set_region(const Polygon& polygon) {
+
+        region = std::make_shared<const Polygon>(polygon);
+
+        recount_obtuse_faces();
+
+    }
+
+    bool has_region() const { return static_cast<bool>(region); }
+
+
+
+    //Running number of obtuse faces inside the region, O(1)
+    int number_of_obtuse_faces() const { return obtuse_count; }
+
+    //The counted obtuse faces, kept up to date with the count. The order only changes when the triangulation
+    //changes, so iterating it is repeatable.
+    const std::vector<Face_handle>& obtuse_faces() const { return obtuse_face_list; }
+
+    //A uniformly random counted obtuse face in O(1), Face_handle() if there is none
+    template <class RNG>
+    Face_handle random_obtuse_face(RNG& rng) const {
+
+        if (obtuse_face_list.empty()) return Face_handle();
+
+        std::uniform_int_distribution<std::size_t> distribution(0, obtuse_face_list.size() - 1);
+
+        return obtuse_face_list[distribution(rng)];
+
+    }
+
+
+
+    //Full O(F) recount, it also resets the per face bookkeeping (domain marks included)
+    int recount_obtuse_faces() {
+
+        assign_vertex_ids();
+
+        mark_domain();
+
+        obtuse_count = 0;
+
+        obtuse_face_list.clear();
+
+        for (auto face = this->all_faces_begin(); face != this->all_faces_end(); ++face) {
+
+            face->info().counted_obtuse = false;
+
+            face->info().obtuse_slot = -1;
+
+        }
+
+        if (this->dimension() < 2) return obtuse_count;
+
+        for (auto face = this->finite_faces_begin(); face != this->finite_faces_end(); ++face) {
+
+            face_created(face);
+
+        }
+
+        return obtuse_count;
+
+    }
+
+
+
+    //Give an id to the vertices that CGAL created without one (construction, constraints)
+    void assign_vertex_ids() {
+
+        for (auto v = this->finite_vertices_begin(); v != this->finite_vertices_end(); ++v) {
+
+            if (v->info().id < 0) v->info().id = next_vertex_id++;
+
+        }
+
+    }
+
+
+
+    static int vertex_id(Vertex_handle v) { return v->info().id; }
+
+    //Every id is smaller than this, a vector of this size can be indexed by vertex id
+    int vertex_id_bound() const { return next_vertex_id; }
+
+
+
+    //Insert a point of the input (or find its vertex, e.g. a boundary point) and keep its input index
+    Vertex_handle insert_input_point(const Point& a, int input_index) {
+
+        Vertex_handle va = insert(a);
+
+        va->info().input_index = input_index;
+
+        return va;
+
+    }
+
+    static int input_index(Vertex_handle v) { return v->info().input_index; }
+
+    static bool is_steiner_vertex(Vertex_handle v) { return v->info().input_index < 0; }
+
+    //Key of a face, equal for the same face in every copy of the triangulation
+    static Custom_face_key face_key(Face_handle face) {
+
+        Custom_face_key key = {vertex_id(face->vertex(0)), vertex_id(face->vertex(1)), vertex_id(face->vertex(2))};
+
+        std::sort(key.begin(), key.end());
+
+        return key;
+
+    }
+
+
+
+    //Flood fill from the infinite face across the non-constrained edges. The faces that it reaches are
+    //outside of the domain, all the others are inside. A closed additional constraint does not flip the
+    //side (as the parity of CGAL's mesh domain marking would), it is still inside the region boundary.
+    void mark_domain() {
+
+        for (auto face = this->all_faces_begin(); face != this->all_faces_end(); ++face) {
+
+            face->info().in_domain = (this->dimension() == 2);
+
+        }
+
+        if (this->dimension() < 2) return;
+
+        std::vector<Face_handle> stack;
+
+        Face_handle start = this->infinite_face();
+
+        start->info().in_domain = false;
+
+        stack.push_back(start);
+
+        while (!stack.empty()) {
+
+            Face_handle face = stack.back();
+
+            stack.pop_back();
+
+            for (int i = 0; i < 3; ++i) {
+
+                Face_handle neighbor = face->neighbor(i);
+
+                if (!neighbor->info().in_domain || this->is_constrained(Edge(face, i))) continue;
+
+                neighbor->info().in_domain = false;
+
+                stack.push_back(neighbor);
+
+            }
+
+        }
+
+    }
+
+    //O(1), valid after every insertion and flip
+    static bool is_in_domain(Face_handle face) { return face->info().in_domain; }
+
+
+
+    //Compare the running count with a full recount (debug mode calls it after every update)
+    void check_obtuse_count() const {
+
+        //The domain marks first, the count depends on them. Same flood fill, kept aside in a set.
+        if (this->dimension() == 2) {
+
+            std::set<Face_handle> outside = {this->infinite_face()};
+
+            std::vector<Face_handle> stack(outside.begin(), outside.end());
+
+            while (!stack.empty()) {
+
+                Face_handle face = stack.back();
+
+                stack.pop_back();
+
+                for (int i = 0; i < 3; ++i) {
+
+                    Face_handle neighbor = face->neighbor(i);
+
+                    if (this->is_constrained(Edge(face, i)) || !outside.insert(neighbor).second) continue;
+
+                    stack.push_back(neighbor);
+
+                }
+
+            }
+
+            for (auto face = this->finite_faces_begin(); face != this->finite_faces_end(); ++face) {
+
+                if (is_in_domain(face) == (outside.count(face) > 0)) {
+
+                    throw std::logic_error("Custom CDT: in_domain mark differs from the flood fill");
+
+                }
+
+            }
+
+        }
+
+        int expected = 0;
+
+        if (this->dimension() == 2) {
+
+            for (auto face = this->finite_faces_begin(); face != this->finite_faces_end(); ++face) {
+
+                if (is_obtuse_face(face) && is_face_in_region(face)) expected++;
+
+                Face_record record = classify_face(face);
+
+                if (record.obtuse_vertex != face_record(face).obtuse_vertex || record.longest_edge != face_record(face).longest_edge) {
+
+                    throw std::logic_error("Custom CDT: face record differs from the face");
+
+                }
+
+            }
+
+        }
+
+        if (expected != obtuse_count) {
+
+            throw std::logic_error("Custom CDT: running obtuse count " + std::to_string(obtuse_count) +
+
+                                   " differs from the recount " + std::to_string(expected));
+
+        }
+
+        if (obtuse_face_list.size() != static_cast<std::size_t>(obtuse_count)) {
+
+            throw std::logic_error("Custom CDT: the obtuse face list differs from the running count");
+
+        }
+
+        for (std::size_t slot = 0; slot < obtuse_face_list.size(); ++slot) {
+
+            if (obtuse_face_list[slot]->info().obtuse_slot != static_cast<int>(slot)) {
+
+                throw std::logic_error("Custom CDT: obtuse face list slot mismatch");
+
+            }
+
+        }
+
+    }
 
 
 
@@ -48,23 +506,1313 @@ public:
 
     Vertex_handle insert_no_flip(const Point& a, Face_handle start = Face_handle()) {
 
-        //Call Ctr::insert without flip_around
+        Locate_type lt;
 
-        Vertex_handle va = this->Base::Ctr::insert(a, start); //Directly call Ctr::insert from the base
+        int li;
 
-        return va;
+        Face_handle loc = this->locate(a, lt, li, start);
+
+        return insert_no_flip(a, lt, loc, li);
 
     }
-    
+
     //Another insert method with known location
 
     Vertex_handle insert_no_flip(const Point& a, Locate_type lt, Face_handle loc, int li) {
 
+        //Only insertions that split a face or an edge can be undone
+        if (in_transaction() && (this->dimension() < 2 || lt == Base::OUTSIDE_AFFINE_HULL || lt == Base::OUTSIDE_CONVEX_HULL)) {
+
+            throw std::logic_error("Custom CDT: insertion outside of the convex hull inside a transaction");
+
+        }
+
+        //Lower dimensions only happen while the triangulation is built, just recount
+        if (this->dimension() < 2 || lt == Base::OUTSIDE_AFFINE_HULL) {
+
+            Vertex_handle va = this->Base::Ctr::insert(a, lt, loc, li);
+
+            recount_obtuse_faces();
+
+            return va;
+
+        }
+
+        //The faces that the new vertex splits. The data structure reuses them, the rest of the star is new.
+        //New faces take the domain mark of the face they come from: on an edge, the faces around the
+        //opposite vertex c keep the mark of loc and the rest the mark of its neighbor (they differ only
+        //when the edge is a constraint, e.g. a Steiner point on the region boundary).
+        Vertex_handle c;
+
+        bool c_in_domain = false, other_in_domain = false;
+
+        Undo_entry entry;
+
+        if (lt == Base::FACE) {
+
+            other_in_domain = is_in_domain(loc);
+
+            face_destroyed(loc);
+
+            entry.kind = Undo_entry::INSERT_IN_FACE;
+
+            entry.f = loc;
+
+            entry.f_in_domain = other_in_domain;
+
+        }
+
+        if (lt == Base::EDGE) {
+
+            Face_handle neighbor = loc->neighbor(li);
+
+            c = loc->vertex(li);
+
+            c_in_domain = is_in_domain(loc);
+
+            other_in_domain = is_in_domain(neighbor);
+
+            face_destroyed(loc);
+
+            face_destroyed(neighbor);
+
+            entry.kind = Undo_entry::INSERT_IN_EDGE;
+
+            entry.f = loc;
+
+            entry.i = li;
+
+            entry.n = neighbor;
+
+            entry.ni = this->mirror_index(loc, li);
+
+            entry.constrained = loc->is_constrained(li);
+
+            entry.f_in_domain = c_in_domain;
+
+            entry.n_in_domain = other_in_domain;
+
+        }
+
         Vertex_handle va = this->Base::Ctr::insert(a, lt, loc, li); //Directly call Ctr::insert from the base
 
-        return va;
+        if (lt != Base::VERTEX) va->info().id = next_vertex_id++;
+
+        if (lt != Base::VERTEX) faces_created_around(va, c, c_in_domain, other_in_domain);
+
+        if (lt != Base::VERTEX && in_transaction()) {
+
+            entry.v = va;
+
+            undo_log.push_back(entry);
+
+        }
+
+        debug_check();
+
+        return va;
+
+    }
+
+
+
+    //Delaunay insertion: insert without flips, then restore the Delaunay property around the new vertex
+    //with the same propagating flips as CGAL, but through flip() so that the bookkeeping follows.
+    Vertex_handle insert(const Point& a, Face_handle start = Face_handle()) {
+
+        Vertex_handle va = insert_no_flip(a, start);
+
+        flip_around(va);
+
+        return va;
+
+    }
+
+    void flip_around(Vertex_handle va) {
+
+        if (this->dimension() <= 1) return;
+
+        Face_handle f = va->face();
+
+        Face_handle next;
+
+        Face_handle start(f);
+
+        int i;
+
+        do {
+
+            i = f->index(va); //Edge opposite to va
+
+            next = f->neighbor(this->ccw(i));
+
+            propagating_flip(f, i);
+
+            f = next;
+
+        } while (next != start);
+
+    }
+
+
+
+    //Flip the edge (f, i). The two faces are rebuilt in place.
+    //The edge is not a constraint, so both faces are on the same side of the domain and stay there.
+    void flip(Face_handle& f, int i) {
+
+        if (in_transaction()) {
+
+            Undo_entry entry;
+
+            entry.kind = Undo_entry::FLIP;
+
+            entry.f = f;
+
+            entry.i = i;
+
+            undo_log.push_back(entry);
+
+        }
+
+        Face_handle n = f->neighbor(i);
+
+        bool in_domain = is_in_domain(f);
+
+        face_destroyed(f);
+
+        face_destroyed(n);
+
+        Base::flip(f, i);
+
+        f->info().in_domain = n->info().in_domain = in_domain;
+
+        face_created(f);
+
+        face_created(n);
+
+        debug_check();
+
+    }
+
+
+
+    //Worklist flip engine. The worklist starts with the edges of the faces around seed (every finite edge
+    //when seed is null) and after a flip only the four outer edges of the flipped quad are queued, so
+    //an edge is evaluated again only if its neighborhood changed.
+    //Constrained edges and edges with a face outside of the domain are never flipped. For the rest
+    //accept(p1, p2, p3, p4) decides: p1, p3 the edge, p2, p4 the opposite vertices.
+    template <class Accept>
+    Flip_stats flip_edges(Vertex_handle seed, Accept accept) {
+
+        Flip_stats stats;
+
+        if (this->dimension() < 2) return stats;
+
+        using Vertex_pair = std::pair<Vertex_handle, Vertex_handle>;
+
+        std::deque<Vertex_pair> worklist;
+
+        std::set<Vertex_pair> queued;
+
+        auto push = [&](Vertex_handle u, Vertex_handle v) {
+
+            if (this->is_infinite(u) || this->is_infinite(v)) return;
+
+            Vertex_pair key = (v < u) ? Vertex_pair(v, u) : Vertex_pair(u, v);
+
+            if (queued.insert(key).second) worklist.push_back(key);
+
+        };
+
+        if (seed == Vertex_handle()) {
+
+            for (auto edge = this->finite_edges_begin(); edge != this->finite_edges_end(); ++edge) {
+
+                push(edge->first->vertex(this->ccw(edge->second)), edge->first->vertex(this->cw(edge->second)));
+
+            }
+
+        }
+
+        else {
+
+            Face_circulator face = this->incident_faces(seed), done(face);
+
+            if (face != nullptr) {
+
+                do {
+
+                    for (int i = 0; i < 3; ++i) push(face->vertex(this->ccw(i)), face->vertex(this->cw(i)));
+
+                } while (++face != done);
+
+            }
+
+        }
+
+        while (!worklist.empty()) {
+
+            Vertex_pair key = worklist.front();
+
+            worklist.pop_front();
+
+            queued.erase(key);
+
+            //The edge may be gone after the flips in between
+            Face_handle f;
+
+            int i;
+
+            if (!this->is_edge(key.first, key.second, f, i)) continue;
+
+            Face_handle n = f->neighbor(i);
+
+            if (this->is_infinite(f) || this->is_infinite(n) || this->is_constrained(Edge(f, i))) continue;
+
+            if (!is_in_domain(f) || !is_in_domain(n)) continue;
+
+            Vertex_handle v1 = f->vertex(this->ccw(i));
+
+            Vertex_handle v2 = f->vertex(i);
+
+            Vertex_handle v3 = f->vertex(this->cw(i));
+
+            Vertex_handle v4 = n->vertex(this->mirror_index(f, i));
+
+            stats.attempted++;
+
+            if (!accept(v1->point(), v2->point(), v3->point(), v4->point())) continue;
+
+            flip(f, i);
+
+            stats.applied++;
+
+            push(v1, v2);
+
+            push(v2, v3);
+
+            push(v3, v4);
+
+            push(v4, v1);
+
+        }
+
+        total_flips.attempted += stats.attempted;
+
+        total_flips.applied += stats.applied;
+
+        return stats;
+
+    }
+
+    //Counters of every flip_edges call on this triangulation (copies included)
+    const Flip_stats& flip_statistics() const { return total_flips; }
+
+
+
+    //Result of evaluate_insertion()
+    struct Insertion_delta {
+
+        //False if the point can not be evaluated (it is a vertex or outside of the convex hull)
+        bool valid = false;
+
+        //Predicted change of the number of obtuse faces inside the region
+        int obtuse_delta = 0;
+
+        //Faces of the triangulation that the insertion and its flips would destroy
+        std::vector<Face_handle> destroyed_faces;
+
+        //The faces that would replace them
+        std::vector<std::array<Point, 3>> created_faces;
+
+        //Flips of the simulated cascade
+        Flip_stats flips;
+
+    };
+
+    //Predict insert_no_flip(a) followed by flip_edges(new vertex, accept) without modifying the triangulation.
+    //The located faces are copied into a scratch patch, the point is inserted there and the same worklist
+    //runs on the patch. The patch grows one face at a time, only where the cascade reaches its border, so
+    //the cost is proportional to the change and not to the size of the triangulation.
+    template <class Accept>
+    Insertion_delta evaluate_insertion(const Point& a, Accept accept, Face_handle start = Face_handle()) const {
+
+        Insertion_delta delta;
+
+        if (this->dimension() < 2) return delta;
+
+        Locate_type lt;
+
+        int li;
+
+        Face_handle loc = this->locate(a, lt, li, start);
+
+        if (lt != Base::FACE && lt != Base::EDGE) return delta;
+
+        //On a convex hull edge, split from the finite side
+        if (this->is_infinite(loc)) {
+
+            if (lt != Base::EDGE) return delta;
+
+            Face_handle neighbor = loc->neighbor(li);
+
+            li = this->mirror_index(loc, li);
+
+            loc = neighbor;
+
+        }
+
+        Local_patch patch(*this);
+
+        int f = patch.fetch(loc);
+
+        int va = patch.add_point(a);
+
+        if (lt == Base::FACE) patch.insert_in_face(f, va);
+
+        else {
+
+            if (!this->is_infinite(loc->neighbor(li))) patch.fetch(loc->neighbor(li));
+
+            patch.insert_in_edge(f, li, va);
+
+        }
+
+        delta.flips = patch.flip_edges(va, accept);
+
+        delta.valid = true;
+
+        delta.obtuse_delta = patch.obtuse_delta;
+
+        delta.destroyed_faces = patch.destroyed;
+
+        for (const auto& face : patch.faces) {
+
+            if (face.origin != Face_handle()) continue;
+
+            delta.created_faces.push_back({patch.points[face.v[0]], patch.points[face.v[1]], patch.points[face.v[2]]});
+
+        }
+
+        return delta;
+
+    }
+
+
+
+    //Transactions. Every insertion and flip after begin_transaction() is recorded in an undo log and
+    //rollback_transaction() undoes them in reverse order, in time proportional to the change. The undo
+    //restores the same face objects, so face handles taken before begin stay valid after a rollback.
+    //Transactions nest: an inner commit keeps its records for the rollback of the outer one. A rollback also
+    //gives back the vertex ids of the undone insertions, the ids of the vertices follow the committed ones.
+    void begin_transaction() { transaction_marks.push_back({undo_log.size(), next_vertex_id}); }
+
+    bool in_transaction() const { return !transaction_marks.empty(); }
+
+    void commit_transaction() {
+
+        if (!in_transaction()) throw std::logic_error("Custom CDT: commit without a transaction");
+
+        transaction_marks.pop_back();
+
+        if (!in_transaction()) undo_log.clear();
+
+    }
+
+    void rollback_transaction() { rollback(nullptr); }
+
+    //Same, and collect the faces that the transaction had changed (valid again after the rollback)
+    void rollback_transaction(std::set<Face_handle>& changed_faces) { rollback(&changed_faces); }
+
+
+
+    //Constraint insertion may delete faces (and insert vertices with flips), so recount afterwards.
+    //It only happens while the triangulation is built, it cannot be part of a transaction.
+    using Base::insert_constraint;
+
+    void insert_constraint(const Point& a, const Point& b) {
+
+        if (in_transaction()) throw std::logic_error("Custom CDT: insert_constraint inside a transaction");
+
+        Base::insert_constraint(a, b);
+
+        recount_obtuse_faces();
+
+    }
+
+    void insert_constraint(Vertex_handle va, Vertex_handle vb) {
+
+        if (in_transaction()) throw std::logic_error("Custom CDT: insert_constraint inside a transaction");
+
+        Base::insert_constraint(va, vb);
+
+        recount_obtuse_faces();
+
+    }
+
+
+
+    using Face_record = Custom_face_record;
+
+    //The classification record of a finite face. It is only read here (face_created computes it), so threads may
+    //read the faces of a triangulation that none of them modifies
+    static const Face_record& face_record(Face_handle face) {
+
+        return face->info().record;
+
+    }
+
+    //Classification of a finite face from filtered predicates, without exact constructions
+    static Face_record classify_face(Face_handle face) {
+
+        const Point& p0 = face->vertex(0)->point();
+
+        const Point& p1 = face->vertex(1)->point();
+
+        const Point& p2 = face->vertex(2)->point();
+
+        Face_record record;
+
+        record.obtuse_vertex = filtered_obtuse_vertex(p0, p1, p2);
+
+        //Exact on ties: the first of (p0, p1), (p1, p2), (p2, p0). compare_distance_to_point(p, q, r) compares |pq|, |pr|
+        if (CGAL::compare_distance_to_point(p1, p0, p2) != CGAL::SMALLER &&
+
+            CGAL::compare_distance_to_point(p0, p1, p2) != CGAL::SMALLER) record.longest_edge = 2;
+
+        else if (CGAL::compare_distance_to_point(p2, p1, p0) != CGAL::SMALLER) record.longest_edge = 0;
+
+        else record.longest_edge = 1;
+
+        //rho = R / h, h the height on the longest edge, in doubles: R = d0 d1 d2 / (4 area), the area from Heron's formula
+        double x0 = CGAL::to_double(p0.x()), y0 = CGAL::to_double(p0.y());
+
+        double x1 = CGAL::to_double(p1.x()), y1 = CGAL::to_double(p1.y());
+
+        double x2 = CGAL::to_double(p2.x()), y2 = CGAL::to_double(p2.y());
+
+        double d0 = std::hypot(x1 - x2, y1 - y2);
+
+        double d1 = std::hypot(x2 - x0, y2 - y0);
+
+        double d2 = std::hypot(x0 - x1, y0 - y1);
+
+        double s = (d0 + d1 + d2) / 2.0;
+
+        double area = std::sqrt(s * (s - d0) * (s - d1) * (s - d2));
+
+        double R = d0 * d1 * d2 / (4 * area);
+
+        record.rho = R / ((2 * area) / std::max({d0, d1, d2}));
+
+        return record;
+
+    }
+
+
+
+    static bool is_obtuse_face(Face_handle face) {
+
+        return is_obtuse_triangle(face->vertex(0)->point(), face->vertex(1)->point(), face->vertex(2)->point());
+
+    }
+
+    static bool is_obtuse_triangle(const Point& a, const Point& b, const Point& c) {
+
+        return filtered_is_obtuse(a, b, c);
+
+    }
+
+
+
+    //The region boundary is inserted as constraints, so the domain marks decide
+    bool is_face_in_region(Face_handle face) const {
+
+        return !region || is_in_domain(face);
+
+    }
+
+
+
+    //True if the edge (face, i) is on the region boundary: it is a constraint and the domain marks differ across
+    //it. A Steiner point on the boundary splits the constraint and its two halves keep both marks, so the test
+    //stays O(1) and up to date without looking at the polygon.
+    bool is_boundary_edge(Face_handle face, int i) const {
+
+        return this->is_constrained(Edge(face, i)) && is_in_domain(face) != is_in_domain(face->neighbor(i));
+
+    }
+
+
+
+protected:
+
+    //One record of the undo log
+    struct Undo_entry {
+
+        enum Kind { FLIP, INSERT_IN_FACE, INSERT_IN_EDGE };
+
+        Kind kind = FLIP;
+
+        //FLIP: the arguments of the flip. INSERT_*: the located face (and edge index)
+        Face_handle f;
+
+        int i = -1;
+
+        //INSERT_IN_EDGE: the other face of the split edge
+        Face_handle n;
+
+        int ni = -1;
+
+        //INSERT_*: the new vertex
+        Vertex_handle v;
+
+        //INSERT_IN_EDGE: the split edge was a constraint
+        bool constrained = false;
+
+        //INSERT_*: domain marks of f and n before the insertion
+        bool f_in_domain = false;
+
+        bool n_in_domain = false;
+
+    };
+
+
+
+    //Scratch copy of a few faces for evaluate_insertion(). A face keeps its vertices (indices in points),
+    //its neighbors (indices in faces, NOT_FETCHED if the face across is still only in the triangulation,
+    //INFINITE for the convex hull) and the constraint and domain marks. origin is the face of the
+    //triangulation that it copies, null once the patch has changed it.
+    class Local_patch {
+
+    public:
+
+        enum { NOT_FETCHED = -1, INFINITE = -2 };
+
+        struct Patch_face {
+
+            int v[3];
+
+            int n[3];
+
+            bool constrained[3];
+
+            bool in_domain;
+
+            Face_handle origin;
+
+        };
+
+        explicit Local_patch(const Custom_Constrained_Delaunay_triangulation_2& cdt) : cdt(cdt) {}
+
+        const Custom_Constrained_Delaunay_triangulation_2& cdt;
+
+        std::vector<Point> points;
+
+        std::vector<Vertex_handle> handles;
+
+        std::map<Vertex_handle, int> vertex_index;
+
+        std::vector<Patch_face> faces;
+
+        std::map<Face_handle, int> fetched;
+
+        std::vector<Face_handle> destroyed;
+
+        int obtuse_delta = 0;
+
+        int add_point(const Point& p) {
+
+            points.push_back(p);
+
+            handles.push_back(Vertex_handle());
+
+            return static_cast<int>(points.size()) - 1;
+
+        }
+
+        int add_vertex(Vertex_handle v) {
+
+            auto found = vertex_index.find(v);
+
+            if (found != vertex_index.end()) return found->second;
+
+            int index = add_point(v->point());
+
+            handles[index] = v;
+
+            vertex_index[v] = index;
+
+            return index;
+
+        }
+
+        bool counted(const Patch_face& face) const {
+
+            return (!cdt.has_region() || face.in_domain) &&
+                   is_obtuse_triangle(points[face.v[0]], points[face.v[1]], points[face.v[2]]);
+
+        }
+
+        //Slot of face f for the edge (a, b), -1 if it has no such edge
+        int slot_of(int f, int a, int b) const {
+
+            for (int k = 0; k < 3; ++k) {
+
+                int u = faces[f].v[ccw(k)], w = faces[f].v[cw(k)];
+
+                if ((u == a && w == b) || (u == b && w == a)) return k;
+
+            }
+
+            return -1;
+
+        }
+
+        //Copy a finite face of the triangulation and link it to the patch faces around it
+        int fetch(Face_handle fh) {
+
+            Patch_face face;
+
+            for (int k = 0; k < 3; ++k) face.v[k] = add_vertex(fh->vertex(k));
+
+            for (int k = 0; k < 3; ++k) {
+
+                face.constrained[k] = fh->is_constrained(k);
+
+                face.n[k] = cdt.is_infinite(fh->neighbor(k)) ? INFINITE : NOT_FETCHED;
+
+            }
+
+            face.in_domain = is_in_domain(fh);
+
+            face.origin = fh;
+
+            int f = static_cast<int>(faces.size());
+
+            faces.push_back(face);
+
+            fetched[fh] = f;
+
+            //The patch faces that hold the open side of one of its edges (they may have been rebuilt already)
+            for (int k = 0; k < 3; ++k) {
+
+                if (faces[f].n[k] != NOT_FETCHED || !fetched.count(fh->neighbor(k))) continue;
+
+                for (int g = 0; g < f; ++g) {
+
+                    int j = slot_of(g, faces[f].v[ccw(k)], faces[f].v[cw(k)]);
+
+                    if (j < 0 || faces[g].n[j] != NOT_FETCHED) continue;
+
+                    faces[f].n[k] = g;
+
+                    faces[g].n[j] = f;
+
+                    break;
+
+                }
+
+            }
+
+            return f;
+
+        }
+
+        //Neighbor of f across k, fetched from the triangulation if needed
+        int neighbor(int f, int k) {
+
+            if (faces[f].n[k] != NOT_FETCHED) return faces[f].n[k];
+
+            Face_handle fh;
+
+            int i;
+
+            cdt.is_edge(handles[faces[f].v[ccw(k)]], handles[faces[f].v[cw(k)]], fh, i);
+
+            if (fetched.count(fh)) fh = fh->neighbor(i);
+
+            fetch(fh);
+
+            return faces[f].n[k];
+
+        }
+
+        //Take the contribution of face f back, it is about to be rebuilt
+        void destroy(int f) {
+
+            if (counted(faces[f])) obtuse_delta--;
+
+            if (faces[f].origin != Face_handle()) destroyed.push_back(faces[f].origin);
+
+            faces[f].origin = Face_handle();
+
+        }
+
+        //Replace the faces old_faces by triangles (ccw vertex triples, with their domain marks). The outer
+        //edges keep their neighbors and constraint marks. The edges between two new triangles are free,
+        //except the halves of a split constrained edge (split_a, split_b, split_v).
+        void retriangulate(const std::vector<int>& old_faces, const std::vector<std::array<int, 3>>& triangles,
+                           const std::vector<bool>& in_domain, int split_a = -1, int split_b = -1, int split_v = -1,
+                           bool split_constrained = false) {
+
+            struct Outer_edge { int a, b, n, n_slot; bool constrained; };
+
+            std::vector<Outer_edge> outer;
+
+            for (int f : old_faces) {
+
+                destroy(f);
+
+                for (int k = 0; k < 3; ++k) {
+
+                    int n = faces[f].n[k];
+
+                    if (std::find(old_faces.begin(), old_faces.end(), n) != old_faces.end()) continue;
+
+                    int a = faces[f].v[ccw(k)], b = faces[f].v[cw(k)];
+
+                    outer.push_back({a, b, n, n >= 0 ? slot_of(n, a, b) : -1, faces[f].constrained[k]});
+
+                }
+
+            }
+
+            std::vector<int> created;
+
+            for (std::size_t t = 0; t < triangles.size(); ++t) {
+
+                int f = t < old_faces.size() ? old_faces[t] : static_cast<int>(faces.size());
+
+                if (f == static_cast<int>(faces.size())) faces.push_back(Patch_face());
+
+                for (int k = 0; k < 3; ++k) faces[f].v[k] = triangles[t][k];
+
+                faces[f].in_domain = in_domain[t];
+
+                faces[f].origin = Face_handle();
+
+                created.push_back(f);
+
+            }
+
+            for (int f : created) {
+
+                for (int k = 0; k < 3; ++k) {
+
+                    int a = faces[f].v[ccw(k)], b = faces[f].v[cw(k)];
+
+                    bool linked = false;
+
+                    for (int g : created) {
+
+                        int j = (g == f) ? -1 : slot_of(g, a, b);
+
+                        if (j < 0) continue;
+
+                        faces[f].n[k] = g;
+
+                        faces[f].constrained[k] = split_constrained && (a == split_v || b == split_v) &&
+                                                  (a == split_a || b == split_a || a == split_b || b == split_b);
+
+                        linked = true;
+
+                        break;
+
+                    }
+
+                    for (std::size_t e = 0; !linked && e < outer.size(); ++e) {
+
+                        if (!((outer[e].a == a && outer[e].b == b) || (outer[e].a == b && outer[e].b == a))) continue;
+
+                        faces[f].n[k] = outer[e].n;
+
+                        faces[f].constrained[k] = outer[e].constrained;
+
+                        if (outer[e].n >= 0) faces[outer[e].n].n[outer[e].n_slot] = f;
+
+                        linked = true;
+
+                    }
+
+                    //Half of a split convex hull edge
+                    if (!linked) {
+
+                        faces[f].n[k] = INFINITE;
+
+                        faces[f].constrained[k] = split_constrained;
+
+                    }
+
+                }
+
+                if (counted(faces[f])) obtuse_delta++;
+
+            }
+
+        }
+
+        //Same faces as Ctr::insert in a face: (v, b, c), (a, v, c), (a, b, v)
+        void insert_in_face(int f, int v) {
+
+            int a = faces[f].v[0], b = faces[f].v[1], c = faces[f].v[2];
+
+            bool in_domain = faces[f].in_domain;
+
+            retriangulate({f}, {{{v, b, c}}, {{a, v, c}}, {{a, b, v}}}, {in_domain, in_domain, in_domain});
+
+        }
+
+        //Split the edge (f, i): each of the two faces in two, each half keeps the mark of its face
+        void insert_in_edge(int f, int i, int v) {
+
+            int c = faces[f].v[i], a = faces[f].v[ccw(i)], b = faces[f].v[cw(i)];
+
+            bool constrained = faces[f].constrained[i];
+
+            int n = faces[f].n[i];
+
+            if (n < 0) {
+
+                retriangulate({f}, {{{c, a, v}}, {{c, v, b}}}, {faces[f].in_domain, faces[f].in_domain}, a, b, v, constrained);
+
+                return;
+
+            }
+
+            int d = faces[n].v[slot_of(n, a, b)];
+
+            bool f_in_domain = faces[f].in_domain, n_in_domain = faces[n].in_domain;
+
+            retriangulate({f, n}, {{{c, a, v}}, {{c, v, b}}, {{d, b, v}}, {{d, v, a}}},
+                          {f_in_domain, f_in_domain, n_in_domain, n_in_domain}, a, b, v, constrained);
+
+        }
+
+        //Same worklist as Custom CDT::flip_edges, seeded with the faces around v
+        template <class Accept>
+        Flip_stats flip_edges(int v, Accept accept) {
+
+            Flip_stats stats;
+
+            std::deque<std::pair<int, int>> worklist;
+
+            std::set<std::pair<int, int>> queued;
+
+            auto push = [&](int a, int b) {
+
+                std::pair<int, int> key(std::min(a, b), std::max(a, b));
+
+                if (queued.insert(key).second) worklist.push_back(key);
+
+            };
+
+            for (std::size_t f = 0; f < faces.size(); ++f) {
+
+                if (faces[f].v[0] != v && faces[f].v[1] != v && faces[f].v[2] != v) continue;
+
+                for (int k = 0; k < 3; ++k) push(faces[f].v[ccw(k)], faces[f].v[cw(k)]);
+
+            }
+
+            while (!worklist.empty()) {
+
+                std::pair<int, int> key = worklist.front();
+
+                worklist.pop_front();
+
+                queued.erase(key);
+
+                int f = -1, i = -1;
+
+                for (std::size_t g = 0; g < faces.size() && i < 0; ++g) {
+
+                    i = slot_of(static_cast<int>(g), key.first, key.second);
+
+                    f = static_cast<int>(g);
+
+                }
+
+                if (i < 0 || faces[f].constrained[i] || faces[f].n[i] == INFINITE) continue;
+
+                int n = neighbor(f, i);
+
+                if (n == INFINITE || !faces[f].in_domain || !faces[n].in_domain) continue;
+
+                int v1 = faces[f].v[ccw(i)], v2 = faces[f].v[i], v3 = faces[f].v[cw(i)];
+
+                int v4 = faces[n].v[slot_of(n, v1, v3)];
+
+                stats.attempted++;
+
+                if (!accept(points[v1], points[v2], points[v3], points[v4])) continue;
+
+                //The quad is (v2, v1, v4, v3) in ccw order, the new edge is v2 v4
+                bool in_domain = faces[f].in_domain;
+
+                retriangulate({f, n}, {{{v2, v1, v4}}, {{v2, v4, v3}}}, {in_domain, in_domain});
+
+                stats.applied++;
+
+                push(v1, v2);
+
+                push(v2, v3);
+
+                push(v3, v4);
+
+                push(v4, v1);
+
+            }
+
+            return stats;
+
+        }
+
+        static int ccw(int i) { return (i + 1) % 3; }
+
+        static int cw(int i) { return (i + 2) % 3; }
+
+    };
+
+
+
+    //Hook: face is about to be rebuilt or deleted, take back its contribution
+    void face_destroyed(Face_handle face) {
+
+        if (face->info().counted_obtuse) {
+
+            obtuse_count--;
+
+            face->info().counted_obtuse = false;
+
+            //Swap with the last one and pop
+            int slot = face->info().obtuse_slot;
+
+            Face_handle last = obtuse_face_list.back();
+
+            obtuse_face_list[slot] = last;
+
+            last->info().obtuse_slot = slot;
+
+            obtuse_face_list.pop_back();
+
+            face->info().obtuse_slot = -1;
+
+        }
+
+    }
+
+
+
+    //Hook: face has just been created or rebuilt, add its contribution
+    void face_created(Face_handle face) {
+
+        if (this->is_infinite(face)) return;
+
+        face->info().record = classify_face(face);
+
+        face->info().counted_obtuse = face->info().record.obtuse_vertex >= 0 && is_face_in_region(face);
+
+        if (face->info().counted_obtuse) {
+
+            obtuse_count++;
+
+            face->info().obtuse_slot = static_cast<int>(obtuse_face_list.size());
+
+            obtuse_face_list.push_back(face);
+
+        }
+
+    }
+
+
+
+    //Every face around a new vertex is created or rebuilt (reused faces still carry their old contribution).
+    //The faces incident to c get c_in_domain, the others other_in_domain.
+    void faces_created_around(Vertex_handle va, Vertex_handle c, bool c_in_domain, bool other_in_domain) {
+
+        Face_circulator face = this->incident_faces(va), done(face);
+
+        if (face == nullptr) return;
+
+        do {
+
+            face_destroyed(face);
+
+            face->info().in_domain = !this->is_infinite(face) &&
+                                     ((c != Vertex_handle() && face->has_vertex(c)) ? c_in_domain : other_in_domain);
+
+            face_created(face);
+
+        } while (++face != done);
+
+    }
+
+
+
+    //Same recursion as CGAL's Constrained_Delaunay_triangulation_2::propagating_flip
+    void propagating_flip(Face_handle& f, int i) {
+
+        if (!this->is_flipable(f, i)) return;
+
+        Face_handle ni = f->neighbor(i);
+
+        flip(f, i);
+
+        propagating_flip(f, i);
+
+        i = ni->index(f->vertex(i));
+
+        propagating_flip(ni, i);
+
+    }
+
+
+
+    //Undo the log back to the mark of the innermost transaction. Faces touched on the way are collected in
+    //changed (if given), except the ones that the transaction had created, which are deleted again.
+    void rollback(std::set<Face_handle>* changed) {
+
+        if (!in_transaction()) throw std::logic_error("Custom CDT: rollback without a transaction");
+
+        Transaction_mark mark = transaction_marks.back();
+
+        transaction_marks.pop_back();
+
+        while (undo_log.size() > mark.undo_size) {
+
+            Undo_entry entry = undo_log.back();
+
+            undo_log.pop_back();
+
+            if (entry.kind == Undo_entry::FLIP) undo_flip(entry.f, entry.i, changed);
+
+            else undo_insert(entry, changed);
+
+        }
+
+        next_vertex_id = mark.next_vertex_id;
+
+#ifdef CUSTOM_CDT_DEBUG
+
+        if (!this->tds().is_valid()) throw std::logic_error("Custom CDT: invalid data structure after rollback");
+
+#endif
+
+        debug_check();
+
+    }
+
+    //Exact inverse of Tds::flip(f, i) (after the flip f keeps its vertex i, the new edge is at ccw(i)).
+    //Unlike a second flip it gives each face object its old triangle back.
+    void tds_unflip(Face_handle f, int i) {
+
+        Face_handle n = f->neighbor(this->ccw(i));
+
+        Vertex_handle a = f->vertex(i);
+
+        Vertex_handle d = f->vertex(this->cw(i));
+
+        int ni = n->index(d);
+
+        Vertex_handle b = n->vertex(this->ccw(ni));
+
+        Vertex_handle c = f->vertex(this->ccw(i));
+
+        Face_handle bl = f->neighbor(i);
+
+        int bli = this->mirror_index(f, i);
+
+        Face_handle tr = n->neighbor(ni);
+
+        int tri = this->mirror_index(n, ni);
+
+        f->set_vertex(this->cw(i), b);
+
+        n->set_vertex(this->cw(ni), c);
+
+        link(f, i, n, ni);
+
+        link(f, this->ccw(i), tr, tri);
+
+        link(n, this->ccw(ni), bl, bli);
+
+        if (d->face() == f) d->set_face(n);
+
+        if (a->face() == n) a->set_face(f);
+
+    }
+
+    void link(Face_handle f, int i, Face_handle n, int ni) {
+
+        f->set_neighbor(i, n);
+
+        n->set_neighbor(ni, f);
+
+    }
+
+    //Constraint marks of the edges of f from its neighbors, except the edge shared (if any) that gets shared_constrained
+    void restore_constraints(Face_handle f, int shared = -1, bool shared_constrained = false) {
+
+        for (int j = 0; j < 3; ++j) {
+
+            f->set_constraint(j, (j == shared) ? shared_constrained : f->neighbor(j)->is_constrained(this->mirror_index(f, j)));
+
+        }
+
+    }
+
+    void undo_flip(Face_handle f, int i, std::set<Face_handle>* changed) {
+
+        Face_handle n = f->neighbor(this->ccw(i));
+
+        if (changed) {
+
+            changed->insert(f);
+
+            changed->insert(n);
+
+        }
+
+        bool in_domain = is_in_domain(f);
+
+        face_destroyed(f);
+
+        face_destroyed(n);
+
+        tds_unflip(f, i);
+
+        restore_constraints(f, i, false);
+
+        restore_constraints(n, this->mirror_index(f, i), false);
+
+        f->info().in_domain = n->info().in_domain = in_domain;
+
+        face_created(f);
+
+        face_created(n);
+
+    }
+
+    //Insertion in a face is Tds::insert_in_face(f) and in an edge the same followed by Tds::flip(n, ni),
+    //undo them in reverse order. The vertex has degree 3 again and remove_degree_3 keeps f.
+    void undo_insert(const Undo_entry& entry, std::set<Face_handle>* changed) {
+
+        Face_circulator face = this->incident_faces(entry.v), done(face);
+
+        do {
+
+            face_destroyed(face);
+
+        } while (++face != done);
+
+        if (entry.kind == Undo_entry::INSERT_IN_EDGE) tds_unflip(entry.n, entry.ni);
+
+        if (changed) {
+
+            //The faces around the vertex, except f, were created by the insertion
+            face = this->incident_faces(entry.v);
+
+            done = face;
+
+            do {
+
+                Face_handle created = face;
+
+                if (created != entry.f) changed->erase(created);
+
+            } while (++face != done);
+
+            changed->insert(entry.f);
+
+            if (entry.kind == Undo_entry::INSERT_IN_EDGE) changed->insert(entry.n);
+
+        }
+
+        this->tds().remove_degree_3(entry.v, entry.f);
+
+        if (entry.kind == Undo_entry::INSERT_IN_FACE) {
+
+            restore_constraints(entry.f);
+
+        }
+
+        else {
+
+            restore_constraints(entry.f, entry.i, entry.constrained);
+
+            restore_constraints(entry.n, entry.ni, entry.constrained);
+
+            entry.n->info().in_domain = entry.n_in_domain;
+
+            face_created(entry.n);
+
+        }
+
+        entry.f->info().in_domain = entry.f_in_domain;
+
+        face_created(entry.f);
+
+    }
+
+
+
+    //The list of a copy: its faces with the counted mark, in the order of the faces
+    void rebuild_obtuse_face_list() {
+
+        obtuse_face_list.clear();
+
+        for (auto face = this->all_faces_begin(); face != this->all_faces_end(); ++face) {
+
+            face->info().obtuse_slot = -1;
+
+            if (!face->info().counted_obtuse) continue;
+
+            face->info().obtuse_slot = static_cast<int>(obtuse_face_list.size());
+
+            obtuse_face_list.push_back(face);
+
+        }
+
+    }
+
+
+
+    void debug_check() const {
+
+#ifdef CUSTOM_CDT_DEBUG
+
+        check_obtuse_count();
+
+#endif
+
+    }
+
+
+
+private:
+
+    std::shared_ptr<const Polygon> region;
+
+    int obtuse_count = 0;
+
+    //The counted obtuse faces, face->info().obtuse_slot is the position of a face
+    std::vector<Face_handle> obtuse_face_list;
+
+    Flip_stats total_flips;
+
+    //Id of the next vertex
+    int next_vertex_id = 0;
+
+    std::vector<Undo_entry> undo_log;
+
+    //Size of the undo log and next vertex id at every open begin_transaction()
+    struct Transaction_mark {
+        std::size_t undo_size;
+        int next_vertex_id;
+    };
+    std::vector<Transaction_mark> transaction_marks;
 
-    }
 };
 
-#endif //CGAL_CUSTOM_CONSTRAINED_DELAUNAY_TRIANGULATION_2_H
\ No newline at end of file
+#endif //CGAL_CUSTOM_CONSTRAINED_DELAUNAY_TRIANGULATION_2_H
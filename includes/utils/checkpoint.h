@@ -0,0 +1,43 @@
+//checkpoint.h
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "functions.h"
+
+//What a checkpoint keeps of a run: the best triangulation as its steiner points in insertion order (the input
+//points come from the instance), the region boundary with the splits of update_polygon and the state of the engine
+struct Checkpoint {
+    std_string instance_uid, engine;
+    vector<Point_2> steiner_points;
+    vector<Point_2> polygon;
+    //Iteration of SA and PT, cycle of the ants, remaining L of local search
+    int iteration = 0;
+    //Temperature of SA
+    double temperature = 1.0;
+    //Pheromones of the ants
+    vector<double> taf, delta_taf;
+    //State of the mt19937 of the engine (empty if the engine has none)
+    std_string rng_state;
+};
+
+//The checkpoints of the instance that this thread solves: written to path every interval seconds, and with resume
+//the checkpoint that path already holds (if it is of instance_uid) is loaded. An empty path disables them
+void set_checkpoint_file(const std_string& path, double interval, bool resume, const std_string& instance_uid);
+//The loaded checkpoint, nullptr if the run does not resume
+const Checkpoint* loaded_checkpoint();
+//The engine state of the loaded checkpoint, given once and only to the same engine
+bool take_resume_checkpoint(const std_string& engine, Checkpoint& checkpoint);
+//True when the interval has passed since the last checkpoint (never on a thread without checkpoints)
+bool checkpoint_due();
+//Write state, with the steiner points of best_cdt and polygon, as the checkpoint of the instance
+void save_checkpoint(const std_string& engine, const Custom_CDT& best_cdt, const Polygon& polygon, Checkpoint& state);
+
+//Atomic write (a temporary file renamed over path) and read of a checkpoint file
+bool write_checkpoint(const std_string& path, const Checkpoint& checkpoint);
+bool read_checkpoint(const std_string& path, Checkpoint& checkpoint);
+
+vector<Point_2> steiner_points_in_order(const Custom_CDT& cdt);
+std_string rng_to_string(const std::mt19937& rng);
+void rng_from_string(const std_string& state, std::mt19937& rng);
+
+#endif
@@ -14,7 +14,7 @@
 
 class CDTGraphicsView : public QGraphicsView {
 public:
-    CDTGraphicsView(CDT& cdt, Polygon& polygon, QWidget* parent = nullptr) 
+    CDTGraphicsView(Custom_CDT& cdt, Polygon& polygon, QWidget* parent = nullptr) 
         : QGraphicsView(parent), cdt(cdt), polygon(polygon) {
         //Initialize the scene and set it for this view
         QGraphicsScene* scene = new QGraphicsScene(this);
@@ -136,7 +136,7 @@ protected:
 
             //Check if triangle is obtuse and inside the region boundary
             bool isObtuseTriangle = is_obtuse(fit);
-            bool faceInside = is_face_inside_region(fit, polygon);
+            bool faceInside = is_face_inside_region(fit);
 
             //Check if the triangle is obtuse
             if (isObtuseTriangle && faceInside) {
@@ -238,7 +238,7 @@ protected:
         event->accept();
     }      
 private:
-    CDT& cdt;
+    Custom_CDT& cdt;
     const Polygon& polygon;
     QPointF dragStartPos; //To store the position when dragging starts
     bool dragInProgress = false; //To track if dragging is happening
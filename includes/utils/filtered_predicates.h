@@ -0,0 +1,92 @@
+//filtered_predicates.h
+#ifndef FILTERED_PREDICATES_H
+#define FILTERED_PREDICATES_H
+
+#include <CGAL/enum.h>
+#include <CGAL/FPU.h>
+#include <CGAL/Interval_nt.h>
+#include <CGAL/Uncertain.h>
+#include <CGAL/number_utils.h>
+#include <CGAL/Kernel/global_functions_2.h>
+
+//Filtered predicates for the obtuse and flip tests. Each test is the sign of a dot product or of an
+//orientation determinant. The coordinates are taken as intervals (for a lazy exact point this is the
+//approximation that it already keeps, nothing exact is built) and the polynomial is evaluated once in
+//interval arithmetic. Only when the interval contains zero (near a right angle, near collinear points)
+//the exact predicate of the kernel decides.
+
+using Filter_interval = CGAL::Interval_nt<false>;
+
+//Interval coordinates of a point
+struct Filter_point {
+    Filter_interval x, y;
+};
+
+//Lazy exact point: its cached approximation
+template <class Point>
+auto filter_point(const Point& p, int) -> decltype(p.approx(), Filter_point()) {
+    return {p.approx().x(), p.approx().y()};
+}
+
+//Any other point
+template <class Point>
+Filter_point filter_point(const Point& p, long) {
+    return {Filter_interval(CGAL::to_interval(p.x())), Filter_interval(CGAL::to_interval(p.y()))};
+}
+
+//Dot product (u - o).(v - o), the sign of the angle at o
+inline Filter_interval filter_dot(const Filter_point& o, const Filter_point& u, const Filter_point& v) {
+    return (u.x - o.x) * (v.x - o.x) + (u.y - o.y) * (v.y - o.y);
+}
+
+//Index (0, 1, 2) of the obtuse vertex of the triangle (a, b, c), -1 if it has no obtuse angle
+template <class Point>
+int filtered_obtuse_vertex(const Point& a, const Point& b, const Point& c) {
+    const Point* p[3] = {&a, &b, &c};
+    bool uncertain[3] = {false, false, false};
+    {
+        CGAL::Protect_FPU_rounding<true> protection;
+        Filter_point q[3] = {filter_point(a, 0), filter_point(b, 0), filter_point(c, 0)};
+        for (int i = 0; i < 3; ++i) {
+            CGAL::Uncertain<bool> obtuse = filter_dot(q[i], q[(i + 1) % 3], q[(i + 2) % 3]) < 0;
+            if (!CGAL::is_certain(obtuse)) uncertain[i] = true;
+            //A triangle has at most one obtuse angle
+            else if (CGAL::get_certain(obtuse)) return i;
+        }
+    }
+    //Near a right angle, exact
+    for (int i = 0; i < 3; ++i) {
+        if (uncertain[i] && CGAL::angle(*p[(i + 1) % 3], *p[i], *p[(i + 2) % 3]) == CGAL::OBTUSE) return i;
+    }
+    return -1;
+}
+
+template <class Point>
+bool filtered_is_obtuse(const Point& a, const Point& b, const Point& c) {
+    return filtered_obtuse_vertex(a, b, c) >= 0;
+}
+
+//Same as CGAL::orientation(a, b, c)
+template <class Point>
+CGAL::Orientation filtered_orientation(const Point& a, const Point& b, const Point& c) {
+    {
+        CGAL::Protect_FPU_rounding<true> protection;
+        Filter_point qa = filter_point(a, 0), qb = filter_point(b, 0), qc = filter_point(c, 0);
+        CGAL::Uncertain<CGAL::Sign> sign = CGAL::sign((qb.x - qa.x) * (qc.y - qa.y) - (qb.y - qa.y) * (qc.x - qa.x));
+        if (CGAL::is_certain(sign)) return CGAL::get_certain(sign);
+    }
+    return CGAL::orientation(a, b, c);
+}
+
+//True if (p1, p2, p3, p4) is a convex quadrilateral without three collinear points (either orientation).
+//The four consecutive triples are all the triples of the four points, so this is also the collinearity test.
+template <class Point>
+bool filtered_is_strictly_convex(const Point& p1, const Point& p2, const Point& p3, const Point& p4) {
+    CGAL::Orientation orientation = filtered_orientation(p1, p2, p3);
+    if (orientation == CGAL::COLLINEAR) return false;
+    return filtered_orientation(p2, p3, p4) == orientation &&
+           filtered_orientation(p3, p4, p1) == orientation &&
+           filtered_orientation(p4, p1, p2) == orientation;
+}
+
+#endif
@@ -10,24 +10,133 @@ using K = CGAL::Exact_predicates_exact_constructions_kernel;
 using CDT = CGAL::Constrained_Delaunay_triangulation_2<K>;
 using Point = CDT::Point;
 using Custom_CDT = Custom_Constrained_Delaunay_triangulation_2<K>;
-using Polygon = CGAL::Polygon_2<K>;
+using Polygon = Custom_Polygon_2<K>;
 using Point_2 = K::Point_2;
 using Line_2 = K::Line_2;
 using Segment_2 = K::Segment_2;
 using Face_handle = Custom_CDT::Face_handle;
 using Vertex_handle = Custom_CDT::Vertex_handle;
+using Insertion_delta = Custom_CDT::Insertion_delta;
 using std_string = std::string;
 typedef K::FT FT;
+//The double kernel of the dual kernel mode
+using IK = CGAL::Exact_predicates_inexact_constructions_kernel;
+using Inexact_CDT = Custom_Constrained_Delaunay_triangulation_2<IK>;
+using Inexact_polygon = Custom_Polygon_2<IK>;
+using Inexact_point = IK::Point_2;
+
+//Dual kernel mode: a copy of an exact triangulation with its points rounded to doubles, where the candidates of
+//the searches are built and scored. Only the accepted moves are made in the exact cdt and replayed here
+struct Inexact_mirror {
+    Inexact_CDT cdt;
+    Inexact_polygon polygon;
+    //Moves replayed, and copies of the exact cdt (the first one, after a reset, or when the counts differed)
+    long long replays = 0, rebuilds = 0;
+};
+
+//Where a face of the exact cdt is in a mirror: a point inside of it and the key of the face
+struct Mirror_face {
+    Inexact_point inside;
+    Custom_face_key key;
+};
+
+//A candidate scored on a mirror: found as find_steiner_point, valid and obtuse_delta as evaluate_steiner
+struct Mirror_score {
+    bool found = false, valid = false;
+    int obtuse_delta = 0;
+};
+//Bit length (numerator and denominator) of the coordinates of the steiner points of a triangulation
+struct Coordinate_bits {
+    int coordinates = 0;
+    long long total = 0;
+    size_t max = 0;
+    double mean() const { return coordinates > 0 ? double(total) / coordinates : 0.0; }
+};
+
+//The result of one chain of simulated annealing: its best triangulation (and the polygon of it) with the stats
+struct SA_chain_result {
+    Custom_CDT cdt;
+    Polygon polygon;
+    unsigned int seed = 0;
+    int num_steiners = 0, num_obtuses = 0;
+    double energy = 0.0, rate_of_convergence = 0.0;
+    bool randomization = false;
+    vector<int> count_steiners;
+    vector<Point_2> random_steiners;
+};
+
+//The state of an annealing walk (a chain of simulated annealing or a replica of parallel tempering): the current
+//triangulation, the best one and the counters of the batch resets and of the stats
+struct SA_state {
+    SA_state(const Custom_CDT& cdt, const Polygon& initial_polygon, unsigned int seed, const double& alpha, const double& beta);
+
+    Custom_CDT curent_cdt, best_cdt;
+    Polygon polygon;
+    std::mt19937 rng;
+    unsigned int seed;
+    int init_vertices = 0, obtuse_faces = 0, best_obtuse_faces = 0, previous_obtuses = 0, num_of_transition = 0;
+    double best_E = 0.0, p_sum = 0.0, p_sum_best = 0.0, temp_p_sum = 0.0;
+    vector<int> count_steiners = vector<int>(6, 0), temp_counter_steiner = vector<int>(6, 0);
+    vector<Point_2> vector_random_steiners;
+    Point_2 temp_random_steiner;
+    bool try_randomization = false, randomization = false;
+    //Dual kernel mode: the proposals are scored on the mirror of curent_cdt
+    bool dual_kernel = false;
+    Inexact_mirror mirror;
+};
 
 //Steiner methods
 //void insert_circumcenter_centroid(Custom_CDT& custom_cdt, const Face_handle& face, const Polygon& polygon, Point_2& circum_or_centroid);
 void insert_projection(Custom_CDT& custom_cdt, const Face_handle& face, Polygon& polygon, Point_2& in_projection, Segment_2& opposide_edge);
 void insert_midpoint(Custom_CDT& custom_cdt, const Face_handle& face, Polygon& polygon, Point_2& in_midpoint, Segment_2& longest_edge);
 bool insert_adjacent_steiner(Custom_CDT& custom_cdt, const Face_handle& face, const Polygon& polygon, Point_2& adjacent_steiner);
-void insert_adjacent_steiner_local_search(Custom_CDT& custom_cdt, const Face_handle& face1, const Polygon& polygon, Point_2& adjacent_steiner);
+void insert_adjacent_steiner_local_search(Custom_CDT& custom_cdt, const Face_handle& face1, const Polygon& polygon, Point_2& adjacent_steiner,
+                                          bool snap = false);
+void insert_local_search_steiner(Custom_CDT& custom_cdt, int method, const Face_handle& face, Polygon& polygon,
+                                Point_2& steiner_point, Segment_2& longest_edge, Segment_2& opposide_edge, bool snap = false);
 bool insert_circumcenter(Custom_CDT& circumcenter_cdt, const Face_handle& face, const Polygon& polygon, Point_2& circumcenter_steiner);
 void insert_centroid(Custom_CDT& centroid_cdt, const Face_handle& face, const Polygon& polygon, Point_2& centroid_steiner);
-void insert_steiner_around_centroid(Custom_CDT& custom_cdt, Face_handle& face, Polygon& polygon, Point_2& steiner_around_centroid);
+void insert_steiner_around_centroid(Custom_CDT& custom_cdt, Face_handle& face, Polygon& polygon, Point_2& steiner_around_centroid,
+                                    std::mt19937& rng);
+
+//Steiner points without insertion (return false if the insert method would not insert it)
+bool find_projection(const Face_handle& face, const Polygon& polygon, Point_2& in_projection, Segment_2& opposide_edge);
+bool find_midpoint(const Face_handle& face, const Polygon& polygon, Point_2& in_midpoint, Segment_2& longest_edge);
+bool find_adjacent_steiner(const Custom_CDT& custom_cdt, const Face_handle& face1, const Polygon& polygon, Point_2& adjacent_steiner);
+bool find_circumcenter(const Custom_CDT& circumcenter_cdt, const Face_handle& face, const Polygon& polygon, Point_2& circumcenter_steiner);
+bool find_steiner_point(const Custom_CDT& custom_cdt, int method, const Face_handle& face, const Polygon& polygon,
+                        Point_2& steiner_point, Segment_2& longest_edge, Segment_2& opposide_edge);
+//Predicted change of the obtuse faces if steiner_point is inserted, the cdt is not modified
+Insertion_delta evaluate_steiner(const Custom_CDT& custom_cdt, const Polygon& polygon, const Point_2& steiner_point);
+
+//Dual kernel mode (-dual-kernel)
+void set_dual_kernel(bool enabled);
+bool dual_kernel_enabled();
+Inexact_point to_inexact(const Point_2& p);
+//Make the mirror a copy of cdt (the same faces, constraints and vertex ids) with the points rounded
+void build_mirror(const Custom_CDT& cdt, const Polygon& polygon, Inexact_mirror& mirror);
+Mirror_face mirror_face_of(const Face_handle& face);
+//The steiner of method (0 circumcenter, 1 midpoint, 2 projection, 4 centroid) on face, found and scored on the mirror.
+//False if the mirror cannot answer (the adjacent method, or the face is not in the mirror)
+bool mirror_evaluate(const Inexact_mirror& mirror, int method, const Mirror_face& face, Mirror_score& score);
+//Replay in the mirror the insertion of steiner_point that cdt committed. When the mirror ends up with other
+//vertices, other vertex ids or another obtuse count than cdt, it is copied again from cdt
+void mirror_insert(Inexact_mirror& mirror, const Custom_CDT& cdt, const Polygon& polygon, const Point_2& steiner_point);
+
+//Snapping of the steiner coordinates (-snap-denominator, -simplify-steiners): the largest denominator of a snapped
+//coordinate (0: no snapping before the commits)
+const long long DEFAULT_SNAP_DENOMINATOR = 65536;
+void set_snap_denominator(long long max_denominator);
+long long snap_denominator();
+//Replace steiner_point, before it is inserted in cdt, with the simplest rational point near it that is strictly
+//inside of the same face (or of a face of the same unconstrained edge) and predicts no more obtuse faces. False if
+//the point is kept
+bool snap_steiner_point(const Custom_CDT& cdt, const Polygon& polygon, Point_2& steiner_point);
+//Post-pass: insert the steiners of cdt again, in their order and snapped, into base_cdt (the cdt before any steiner).
+//cdt and polygon take the result only if it has the same steiners and no more obtuse faces
+bool simplify_steiner_points(const Custom_CDT& base_cdt, const Polygon& base_polygon, Custom_CDT& cdt, Polygon& polygon);
+size_t coordinate_bits(const FT& coord);
+Coordinate_bits steiner_coordinate_bits(const Custom_CDT& cdt);
 
 //Helper function for circumcenter, checking if the circumcenter was placed in neighbor face
 bool is_circumcenter_in_neighbor(const Custom_CDT& cdt, const Face_handle& face, const Point_2& circumcenter);
@@ -38,16 +147,35 @@ bool has_obtuse_neighbors(const Custom_CDT& custom_cdt, const Face_handle& face,
 
 //Algorithms
 void local_search(Custom_CDT& custom_cdt, Polygon& polygon, int& L, const std_string& name_of_instance, bool& randomization, 
-                const double& alpha, const double& beta, vector<int> subset, std_string category, const bool& run_auto_method);
+                const double& alpha, const double& beta, vector<int> subset, std_string category, const bool& run_auto_method,
+                const int& num_threads = 1);
+void annealing_sweep(SA_state& state, double& T, int i, int max_iterations, const double& alpha, const double& beta, 
+                const int& batch_size, const vector<int>& subset, const bool& run_auto_method, bool reheat);
+SA_chain_result annealing_result(SA_state& state, const double& alpha, const double& beta, const bool& run_auto_method);
+SA_chain_result simulated_annealing_chain(const Custom_CDT& initial_cdt, const Polygon& initial_polygon, int max_iterations,
+                const double& alpha, const double& beta, const int& batch_size, vector<int> subset,
+                const bool& run_auto_method, unsigned int seed);
 void simulated_annealing(Custom_CDT& custom_cdt, Polygon& polygon, int max_iterations, const double& alpha, 
                 const double& beta, const int& batch_size, const std_string& name_of_instance, bool& randomization, 
-                vector<int> subset, std_string category, const bool& run_auto_method);
+                vector<int> subset, std_string category, const bool& run_auto_method, const int& num_chains = 1);
+void parallel_tempering(Custom_CDT& custom_cdt, Polygon& polygon, int max_iterations, const double& alpha, 
+                const double& beta, const int& batch_size, const std_string& name_of_instance, bool& randomization, 
+                vector<int> subset, std_string category, const bool& run_auto_method, const int& num_replicas);
 void ant_colony(Custom_CDT& custom_cdt, Polygon& polygon, const double& alpha, const double& beta, const double& chi, 
                 const double& psi, const double& lamda, const int& L, const int& kappa, const std_string& name_of_instance, 
-                bool& randomization, vector<int> subset, std_string category, const bool& run_auto_method);
+                bool& randomization, vector<int> subset, std_string category, const bool& run_auto_method,
+                const int& num_threads = 1);
+
+//Helper functions for Local Search
+//Local search methods: 0 circumcenter, 1 midpoint, 2 projection, 3 adjacent, 4 centroid
+const int NUM_LOCAL_SEARCH_METHODS = 5;
+unsigned int score_local_search_steiner(Custom_CDT& custom_cdt, int method, const Face_handle& face, Polygon& polygon);
+void best_local_search_move(const Custom_CDT& custom_cdt, const Polygon& polygon, const vector<Face_handle>& obtuse_faces,
+                            int num_threads, vector<Custom_CDT>& clones, int& best_face, int& best_method,
+                            unsigned int& best_obtuses, const Inexact_mirror* mirror = nullptr);
 
 //Helper functions for Simulated Annealing
-bool should_accept_bad_steiner(const double deltaE, const double T);
+bool should_accept_bad_steiner(const double deltaE, const double T, std::mt19937& rng);
 double calculate_energy(const int obtuse_faces, const int steiner_points, const double alpha, const double beta);
 
 //Helper functions for Ant Colony
@@ -56,25 +184,31 @@ double hta_vertex_projection(double rho);
 double hta_circumcenter(double rho);
 double hta_midpoint(double rho);
 double hta_mean_adjacent(bool has_obtuse_neighbors);
-Face_handle give_random_obtuse(Custom_CDT& custom_cdt, Polygon& polygon);
-SteinerMethod selectSteinerMethod(const double& ro, const vector<double>& taf, vector<double>& hta, double chi, double psi, bool obtuse_neighbors);
+Face_handle give_random_obtuse(const Custom_CDT& custom_cdt, Polygon& polygon, std::mt19937& generator);
+SteinerMethod selectSteinerMethod(const double& ro, const vector<double>& taf, vector<double>& hta, double chi, double psi, bool obtuse_neighbors,
+                                  std::mt19937& gen);
 void updatePheromones(vector<double>& taf, vector<double>& delta_taf, vector<Ant> selected_ants, double lamda);
 bool are_faces_equal(const Face_handle& face1, const Face_handle& face2);
 vector<Ant> save_the_best(vector<Ant>& ants);
 //Check for conflict between 2 ants
 bool have_conflict(Ant& ant1, Ant& ant2);
 void printAntDetails(vector<Ant>& ants);
-void affected_faces(Custom_CDT& best_cdt, Ant& ant);
 
 /*General purpose functions*/
-void start_the_flips(Custom_CDT& cdt, const Polygon& polygon);
+Flip_stats start_the_flips(Custom_CDT& cdt, const Polygon& polygon, Vertex_handle seed = Vertex_handle());
+//The flip rule of start_the_flips
+bool accept_flip(const Point_2& p1, const Point_2& p2, const Point_2& p3, const Point_2& p4);
 //Return true if approves the flip
 bool is_it_worth_flip(const Point_2& p1, const Point_2& p2, const Point_2& p3, const Point_2& p4);
 void update_polygon(Polygon& polygon, const Point_2& steiner_point, const Point_2& point1, const Point_2& point2);
+//The same for a steiner point on any edge of the polygon
+void update_polygon(Polygon& polygon, const Point_2& steiner_point);
+//Insert the steiner points of a solution at once, returns how many are inside the region
+int insert_steiner_points(Custom_CDT& cdt, Polygon& polygon, vector<Point_2> steiner_points);
 bool is_point_inside_region(const Point_2& point, const Polygon& polygon);
-bool is_face_inside_region(const Face_handle& face, const Polygon& polygon);
+bool is_face_inside_region(const Face_handle& face);
 bool is_edge_inside_region(const Point_2& point1, const Point_2& point2, const Polygon& polygon);
-bool is_edge_on_boundary(const Point_2& p1, const Point_2& p2, const Polygon& polygon);
+bool is_edge_on_boundary(const Custom_CDT& custom_cdt, const Face_handle& face, int i);
 Point_2 compute_centroid(const vector<Point_2>& points);
 int count_vertices(const Custom_CDT& cdt);
 void print_polygon_edges(const Polygon& polygon);
@@ -83,18 +217,30 @@ bool is_polygon_convex(const set<Point_2>& unique_points);
 bool is_obtuse(const Face_handle& face);
 //Check if a face (3 points) is obtuse
 bool is_obtuse2(const Point_2& p1, const Point_2& p2, const Point_2& p3);
-//Just count the number of obtuses triangles in a cdt
-int count_obtuse_triangles(CDT& cdt, const Polygon& polygon);
+//Number of obtuse triangles inside the region (O(1) through the Custom CDT counter)
+int count_obtuse_triangles(const Custom_CDT& cdt, const Polygon& polygon);
 //Return true if 2 faces (two triangles) form a convex polygon
 bool is_convex(const Point_2& p1, const Point_2& p2, const Point_2& p3, const Point_2& p4);
 Point_2 find_obtuse_vertex(const Point_2& v1, const Point_2& v2, const Point_2& v3);
+int find_obtuse_vertex_index(const Face_handle& face);
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //JSON INPUT - OUTPUT METHODS
 void read_json(const std_string& filename, value& jv);
+void set_random_seed(unsigned int seed);
+unsigned int next_random_seed();
+//Time limits (seconds, 0 for none) and SIGINT/SIGTERM: the searches stop and return their best triangulation
+void set_run_time_limit(double seconds);
+void set_instance_time_limit(double seconds);
+std::chrono::steady_clock::time_point instance_deadline();
+void set_instance_deadline(std::chrono::steady_clock::time_point deadline);
+bool run_should_stop();
+bool search_should_stop();
+void install_stop_signals();
 void output(value jv, Custom_CDT custom_cdt, vector<Point_2> points, int obtuse_count, std_string output_path, bool randomization);
-bool is_steiner_point(Vertex_handle vertex, const vector<Point_2>& original_points);
+bool is_steiner_point(Vertex_handle vertex);
 std_string convert_to_string(const FT& coord);
+FT convert_from_string(const std_string& text);
 std_string format_double(double value);
 
 //3rd task
@@ -108,12 +254,12 @@ bool is_closed_from_circle(const vector<pair<int, int>>& additional_constraints,
 void method_output(const vector<int> count_steiners, std_string method_name, const std_string& name_of_instance, 
                     const int num_steiners, const int init_num_obtuses, const int num_obtuses, bool randomization, 
                     vector<Point_2>& random_steiners, const double rate_of_convergence, double Energy, vector<int> subset,
-                    std_string category);
+                    std_string category, const std_string& chains_summary = "");
 
 bool are_constraints_open(const vector<pair<int, int>>& additional_constraints, int num_points);
 double p_sum_function(int n_steiner, int previous_obtuses, int obtuse_faces);
 double compute_bounding_circle_radius(Face_handle face, const Point_2& centroid);
-void try_steiner_around_centroid(Custom_CDT& cdt, Polygon& polygon, Point_2& random_steiner);
+void try_steiner_around_centroid(Custom_CDT& cdt, Polygon& polygon, Point_2& random_steiner, std::mt19937& rng);
 void stats_output(const std_string& name_of_instance, const std_string& category);
 
 vector<vector<int>> generateSubsetsWith2(int start, int end);
@@ -1,7 +1,6 @@
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
 #include <CGAL/Constrained_Delaunay_triangulation_2.h>
-#include <CGAL/draw_triangulation_2.h>
 #include <iostream>
 #include <vector>
 #include <stdio.h>
@@ -12,6 +11,7 @@
 #include <CGAL/Polygon_2.h>
 #include <CGAL/number_utils.h>
 #include "includes/utils/Custom_Constrained_Delaunay_triangulation_2.h"
+#include "includes/utils/region_index.h"
 #include <CGAL/Line_2.h>
 #include <CGAL/squared_distance_2.h>
 #include <CGAL/number_utils.h>
@@ -23,7 +23,7 @@ using K = CGAL::Exact_predicates_exact_constructions_kernel;
 using CDT = CGAL::Constrained_Delaunay_triangulation_2<K>;
 using Point = CDT::Point;
 using Custom_CDT = Custom_Constrained_Delaunay_triangulation_2<K>;
-using Polygon = CGAL::Polygon_2<K>;
+using Polygon = Custom_Polygon_2<K>;
 using Point_2 = K::Point_2;
 using Line_2 = K::Line_2;
 using Face_handle = Custom_CDT::Face_handle;
@@ -46,7 +46,7 @@ bool is_in_constraints(const std::pair<int, int> &edge, const vector<std::pair<i
 bool is_in_region_boundary(const std::pair<int, int> &edge, const vector<Point> &boundary);
 
 //Just count the number of obtuses triangles in a cdt
-int count_obtuse_triangles_1(CDT &cdt, const Polygon &polygon);
+int count_obtuse_triangles_1(const Custom_CDT &cdt, const Polygon &polygon);
 
 //Return true if 2 faces (two triangles) form a convex polygon
 bool is_convex_1(const Point_2 &p1, const Point_2 &p2, const Point_2 &p3, const Point_2 &p4);
@@ -54,7 +54,7 @@ bool is_convex_1(const Point_2 &p1, const Point_2 &p2, const Point_2 &p3, const
 //Return true if approves the flip
 bool can_flip(const Point_2 &p1, const Point_2 &p2, const Point_2 &p3, const Point_2 &p4);
 
-void start_the_flips_1(Custom_CDT &cdt, const Polygon &polygon);
+Flip_stats start_the_flips_1(Custom_CDT &cdt, Vertex_handle seed = Vertex_handle());
 
 Point_2 find_obtuse_vertex_1(const Point_2 &v1, const Point_2 &v2, const Point_2 &v3);
 
@@ -70,7 +70,7 @@ Point_2 find_orthocenter(const Point_2 &p1, const Point_2 &p2, const Point_2 &p3
 
 bool is_point_inside_region(const Point_2 &point, const Polygon polygon);
 
-bool is_edge_on_boundary_1(const Point_2 &p1, const Point_2 &p2, const Polygon &polygon);
+bool is_edge_on_boundary_1(const Custom_CDT &custom_cdt, const Face_handle &face, int i);
 
 bool can_insert_centroid(Custom_CDT &custom_cdt, Face_handle &triangleA, const Point_2 &centroid, const Polygon &polygon);
 
@@ -81,6 +81,8 @@ bool is_face_on_boundary(const Custom_CDT &cdt, Custom_CDT::Face_handle face);
 //JSON OUTPUT METHODS
 bool is_steiner_point(Vertex_handle vertex, const std::vector<Point_2> &original_points);
 
+//The stop of the run (functions.cpp), the loops of task1 poll it and keep the triangulation they reached
+bool search_should_stop();
 void run_task1(Custom_CDT& custom_cdt, Polygon& polygon);
-bool is_face_inside_region_1(const Face_handle& face, const Polygon& polygon);
+bool is_face_inside_region_1(const Face_handle& face);
 void update_polygon_1(Polygon& polygon, const Point_2& steiner_point, const Point_2& p1, const Point_2& p2);
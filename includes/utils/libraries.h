@@ -3,11 +3,12 @@
 #define LIBRARIES_H
 
 #include "Custom_Constrained_Delaunay_triangulation_2.h"
+#include "region_index.h"
 
 //CGAL headers
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 #include <CGAL/Constrained_Delaunay_triangulation_2.h>
-#include <CGAL/draw_triangulation_2.h>
 #include <CGAL/convex_hull_2.h>
 #include <CGAL/Polygon_2.h>
 #include <CGAL/number_utils.h>
@@ -15,6 +16,7 @@
 #include <CGAL/squared_distance_2.h>
 #include <CGAL/Polygon_2_algorithms.h>
 #include <CGAL/intersection_2.h>
+#include <CGAL/spatial_sort.h>
 
 //Standard C++ libraries
 #include <iostream>
@@ -26,9 +28,17 @@
 #include <optional>
 #include <random>
 #include <fstream>
+#include <sstream>
 #include <boost/json.hpp>
 #include <algorithm>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <csignal>
+#include <memory>
+#include <exception>
+#include <cstdlib>
 
 //Other libraries
 #include <stdio.h>
@@ -0,0 +1,236 @@
+//region_index.h
+#ifndef REGION_INDEX_H
+#define REGION_INDEX_H
+
+#include <CGAL/enum.h>
+#include <CGAL/Polygon_2.h>
+#include <CGAL/number_utils.h>
+#include <CGAL/Kernel/global_functions_2.h>
+#include "filtered_predicates.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+//Point location in the region boundary in expected O(1). A uniform grid over the bounding box keeps in every
+//cell the polygon edges that may touch it and the side of the center of the cell. A query point p is decided
+//from the center c of its cell: the path p -> (c.x, p.y) -> c stays in the cell, so only the edges of the cell
+//can cross it and every crossing flips the side. All the tests are exact, the doubles only choose the cell.
+//When the path touches the boundary (or p is not certainly in one cell) the polygon itself answers.
+template <class Gt>
+class RegionIndex {
+public:
+    using Point = typename Gt::Point_2;
+    using Polygon = CGAL::Polygon_2<Gt>;
+
+    explicit RegionIndex(const Polygon& polygon) {
+        if (polygon.size() < 3) return;
+        for (auto edge = polygon.edges_begin(); edge != polygon.edges_end(); ++edge) {
+            edges.emplace_back(edge->source(), edge->target());
+        }
+        //About one cell per edge
+        nx = ny = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(edges.size())))));
+        xmin = ymin = HUGE_VAL;
+        xmax = ymax = -HUGE_VAL;
+        for (const auto& edge : edges) {
+            for (const Point* p : {&edge.first, &edge.second}) {
+                std::pair<double, double> x = CGAL::to_interval(p->x()), y = CGAL::to_interval(p->y());
+                xmin = std::min(xmin, x.first);
+                xmax = std::max(xmax, x.second);
+                ymin = std::min(ymin, y.first);
+                ymax = std::max(ymax, y.second);
+            }
+        }
+        w = (xmax - xmin) / nx;
+        h = (ymax - ymin) / ny;
+        if (!(w > 0) || !(h > 0)) {
+            edges.clear();
+            return;
+        }
+        //The cells are taken a little larger than they are, so an edge near a grid line is in both cells.
+        //A query point may be pad out of its cell, the edges are registered 2 * pad out of theirs.
+        pad = 1e-6 * std::min(w, h);
+        cell_edges.assign(nx * ny, std::vector<int>());
+        for (int e = 0; e < static_cast<int>(edges.size()); ++e) {
+            std::pair<double, double> x0 = CGAL::to_interval(edges[e].first.x()), y0 = CGAL::to_interval(edges[e].first.y());
+            std::pair<double, double> x1 = CGAL::to_interval(edges[e].second.x()), y1 = CGAL::to_interval(edges[e].second.y());
+            int i0 = column(std::min(x0.first, x1.first) - 2 * pad), i1 = column(std::max(x0.second, x1.second) + 2 * pad);
+            int j0 = row(std::min(y0.first, y1.first) - 2 * pad), j1 = row(std::max(y0.second, y1.second) + 2 * pad);
+            for (int j = j0; j <= j1; ++j) {
+                for (int i = i0; i <= i1; ++i) cell_edges[j * nx + i].push_back(e);
+            }
+        }
+        //The side of the centers, along every row: the first from the polygon, the next ones from the previous
+        //center and the edges that cross the segment between them (they are in one of the two cells)
+        center_side.assign(nx * ny, UNKNOWN);
+        std::vector<int> seen(edges.size(), -1);
+        for (int j = 0; j < ny; ++j) {
+            for (int i = 0; i < nx; ++i) {
+                int cell = j * nx + i;
+                Point c = center(i, j);
+                if (on_cell_boundary(c, cell)) continue;
+                if (i == 0 || center_side[cell - 1] == UNKNOWN) {
+                    center_side[cell] = (polygon.bounded_side(c) == CGAL::ON_BOUNDED_SIDE) ? INSIDE : OUTSIDE;
+                    continue;
+                }
+                Point previous = center(i - 1, j);
+                int flips = 0;
+                for (int neighbor_cell : {cell - 1, cell}) {
+                    for (int e : cell_edges[neighbor_cell]) {
+                        if (seen[e] == cell) continue;
+                        seen[e] = cell;
+                        flips += crosses_horizontal(edges[e], previous, c);
+                    }
+                }
+                center_side[cell] = (flips % 2 == 0) ? center_side[cell - 1] : 1 - center_side[cell - 1];
+            }
+        }
+    }
+
+    //Same as polygon.bounded_side(p), polygon is the one of the index (or the same region with more vertices)
+    CGAL::Bounded_side bounded_side(const Point& p, const Polygon& polygon) const {
+        if (edges.empty()) return polygon.bounded_side(p);
+        std::pair<double, double> x = CGAL::to_interval(p.x()), y = CGAL::to_interval(p.y());
+        //Out of the bounding box
+        if (x.second < xmin || x.first > xmax || y.second < ymin || y.first > ymax) return CGAL::ON_UNBOUNDED_SIDE;
+        int i = column(0.5 * (x.first + x.second)), j = row(0.5 * (y.first + y.second));
+        //p must be certainly in the (padded) cell
+        if (x.first < xmin + i * w - pad || x.second > xmin + (i + 1) * w + pad ||
+            y.first < ymin + j * h - pad || y.second > ymin + (j + 1) * h + pad) {
+            return polygon.bounded_side(p);
+        }
+        int cell = j * nx + i;
+        if (on_cell_boundary(p, cell)) return CGAL::ON_BOUNDARY;
+        Point c = center(i, j);
+        Point q(c.x(), p.y());
+        if (center_side[cell] == UNKNOWN || on_cell_boundary(q, cell)) return polygon.bounded_side(p);
+        int flips = 0;
+        for (int e : cell_edges[cell]) flips += crosses_horizontal(edges[e], p, q) + crosses_vertical(edges[e], q, c);
+        int side = (flips % 2 == 0) ? center_side[cell] : 1 - center_side[cell];
+        return (side == INSIDE) ? CGAL::ON_BOUNDED_SIDE : CGAL::ON_UNBOUNDED_SIDE;
+    }
+
+private:
+    using Edge = std::pair<Point, Point>;
+    enum { OUTSIDE = 0, INSIDE = 1, UNKNOWN = 2 };
+
+    int column(double x) const { return std::min(nx - 1, std::max(0, static_cast<int>(std::floor((x - xmin) / w)))); }
+    int row(double y) const { return std::min(ny - 1, std::max(0, static_cast<int>(std::floor((y - ymin) / h)))); }
+
+    //Doubles are exact points
+    Point center(int i, int j) const { return Point(xmin + (i + 0.5) * w, ymin + (j + 0.5) * h); }
+
+    static bool on_edge(const Point& p, const Edge& edge) {
+        return filtered_orientation(edge.first, edge.second, p) == CGAL::COLLINEAR &&
+               CGAL::collinear_are_ordered_along_line(edge.first, p, edge.second);
+    }
+
+    bool on_cell_boundary(const Point& p, int cell) const {
+        for (int e : cell_edges[cell]) {
+            if (on_edge(p, edges[e])) return true;
+        }
+        return false;
+    }
+
+    //1 if the edge crosses the horizontal segment ab (a.y == b.y, a and b not on the edge). The edge counts
+    //for y in [min y, max y), the usual half open rule of the crossing number, so a vertex on the line
+    //counts once for the two edges at it.
+    static int crosses_horizontal(const Edge& edge, const Point& a, const Point& b) {
+        bool first_above = edge.first.y() > a.y(), second_above = edge.second.y() > a.y();
+        if (first_above == second_above) return 0;
+        const Point& low = first_above ? edge.second : edge.first;
+        const Point& high = first_above ? edge.first : edge.second;
+        return (filtered_orientation(low, high, a) == CGAL::LEFT_TURN) != (filtered_orientation(low, high, b) == CGAL::LEFT_TURN);
+    }
+
+    //Same for a vertical segment ab (a.x == b.x), half open in x
+    static int crosses_vertical(const Edge& edge, const Point& a, const Point& b) {
+        bool first_right = edge.first.x() > a.x(), second_right = edge.second.x() > a.x();
+        if (first_right == second_right) return 0;
+        const Point& left = first_right ? edge.second : edge.first;
+        const Point& right = first_right ? edge.first : edge.second;
+        return (filtered_orientation(left, right, a) == CGAL::LEFT_TURN) != (filtered_orientation(left, right, b) == CGAL::LEFT_TURN);
+    }
+
+    std::vector<Edge> edges;
+    int nx = 0, ny = 0;
+    double xmin = 0, xmax = 0, ymin = 0, ymax = 0, w = 0, h = 0, pad = 0;
+    std::vector<std::vector<int>> cell_edges;
+    std::vector<int> center_side;
+};
+
+
+
+//The region boundary polygon: a CGAL polygon whose bounded_side goes through a RegionIndex. The index is built
+//on the first query (or by build_region_index) and the copies share it. A vertex inserted on an edge, as
+//update_polygon does with a Steiner point on the boundary, does not change the region and keeps the index;
+//every other change of the vertices drops it.
+template <class Gt>
+class Custom_Polygon_2 : public CGAL::Polygon_2<Gt> {
+public:
+    using Base = CGAL::Polygon_2<Gt>;
+    using typename Base::Point_2;
+    using typename Base::Vertex_iterator;
+
+    Custom_Polygon_2() {}
+
+    Custom_Polygon_2(const Base& polygon) : Base(polygon) {}
+
+    template <class InputIterator>
+    Custom_Polygon_2(InputIterator first, InputIterator last) : Base(first, last) {}
+
+    void build_region_index() const {
+        if (!index) index = std::make_shared<const RegionIndex<Gt>>(*this);
+    }
+
+    CGAL::Bounded_side bounded_side(const Point_2& p) const {
+        build_region_index();
+        return index->bounded_side(p, *this);
+    }
+
+    //The changes of the vertices
+    void push_back(const Point_2& p) {
+        index.reset();
+        Base::push_back(p);
+    }
+
+    Vertex_iterator insert(Vertex_iterator position, const Point_2& p) {
+        if (index && !on_replaced_edge(position, p)) index.reset();
+        return Base::insert(position, p);
+    }
+
+    void erase(Vertex_iterator position) {
+        index.reset();
+        Base::erase(position);
+    }
+
+    void set(Vertex_iterator position, const Point_2& p) {
+        index.reset();
+        Base::set(position, p);
+    }
+
+    void clear() {
+        index.reset();
+        Base::clear();
+    }
+
+    void reverse_orientation() {
+        index.reset();
+        Base::reverse_orientation();
+    }
+
+private:
+    //True if p is on the edge that the insertion before position splits
+    bool on_replaced_edge(Vertex_iterator position, const Point_2& p) {
+        if (this->size() < 2) return false;
+        Vertex_iterator next = (position == this->vertices_end()) ? this->vertices_begin() : position;
+        Vertex_iterator previous = (position == this->vertices_begin()) ? std::prev(this->vertices_end()) : std::prev(position);
+        return CGAL::collinear(*previous, p, *next) && CGAL::collinear_are_ordered_along_line(*previous, p, *next);
+    }
+
+    mutable std::shared_ptr<const RegionIndex<Gt>> index;
+};
+
+#endif
@@ -0,0 +1,37 @@
+//result_cache.h
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "functions.h"
+
+//On-disk cache of the solutions. A solution is kept under the hash of the instance (points, region boundary and
+//constraints) and of the run (method, parameters, delaunay, seed, warm start and the options that change the
+//search), and the best solution of every instance is kept apart as a warm start for any run. The least recently
+//used files are evicted when the cache grows over its size limit
+struct Cache_entry {
+    std_string path;
+    int obtuses = -1, steiners = 0;
+};
+
+//The cache directory (empty: no cache) and its size limit in bytes
+void set_result_cache(const std_string& directory, uintmax_t max_bytes);
+bool result_cache_enabled();
+
+//The hash of the geometry of the instance jv, and of jv with the options of the run in run_key
+std_string instance_cache_key(const value& jv);
+std_string run_cache_key(const value& jv, const std_string& run_key);
+//The hash of the content of a file (of its path if it cannot be read), for the warm start of a run key
+std_string file_cache_key(const std_string& path);
+
+//The cached solution of the same instance and run, and the best known solution of the instance. A hit counts as a
+//use of the file for the eviction
+bool cache_lookup(const value& jv, const std_string& run_key, Cache_entry& entry);
+bool cache_best_known(const value& jv, Cache_entry& entry);
+//Copy the solution file into the cache: as the solution of the run when complete, and as the best known solution
+//if it has fewer obtuses (fewer steiners on a tie)
+void cache_store(const value& jv, const std_string& run_key, const std_string& solution_path, bool complete);
+//Copy the cached solution from to the file to, with the instance_uid of jv (the instances with the same geometry
+//share the files of the cache)
+bool cache_copy_solution(const value& jv, const std_string& from, const std_string& to);
+
+#endif
@@ -0,0 +1,69 @@
+//solver.h
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "functions.h"
+
+//Options of a run that are not in the instance (command line)
+struct Solve_options {
+    bool run_auto_method = false;
+    int num_threads = 1;
+    int num_chains = 1;
+    int num_replicas = 1;
+    //Batch mode: the instances (a directory or a glob) and the number of instances solved at the same time
+    std_string batch;
+    int num_jobs = 1;
+    //Seconds for every instance and for the whole run (0: no limit)
+    double time_limit = 0.0, total_time_limit = 0.0;
+    //Checkpoint file of the instance, written every checkpoint_interval seconds, and resume from it
+    std_string checkpoint_path;
+    double checkpoint_interval = 0.0;
+    bool resume = false;
+    //Solution to start from (in batch mode a directory with the solutions of the instances)
+    std_string warm_start;
+    //Result cache (also from the environment variable OPT_TRIANGULATION_CACHE), its size in megabytes, and the most
+    //obtuses that a cached solution may have to be returned without a run (-1: any cached solution of the same run)
+    std_string cache_dir;
+    double cache_size_mb = 1024.0;
+    int target_obtuses = -1;
+    //Score the candidates of local search and simulated annealing on a double mirror of the triangulation
+    bool dual_kernel = false;
+    //Largest denominator of the snapped steiner coordinates (0: no snapping), and the post-pass that snaps the
+    //steiners of the final triangulation
+    long long snap_denominator = 0;
+    bool simplify_steiners = false;
+    //-seed of the run (without it the seeds come from std::random_device)
+    bool has_seed = false;
+    unsigned int seed = 0;
+};
+
+//An instance after its method: the final triangulation and what the output and the viewer need
+struct Solve_result {
+    std_string instance_uid, method, category;
+    vector<Point_2> points;
+    Polygon polygon;
+    Custom_CDT cdt;
+    int init_obtuses = 0, final_obtuses = 0, num_steiners = 0;
+    double alpha = 0.0, beta = 0.0, energy = 0.0;
+    bool randomization = false;
+    Coordinate_bits coordinate_bits;
+    //The solution came from the cache, only the counts are set
+    bool cached = false;
+};
+
+//Read the options of the command line (-i input -o output and the ones of Solve_options). False if they are wrong
+bool parse_arguments(int argc, char** argv, std_string& input_path, std_string& output_path, Solve_options& options);
+
+//Read the instance jv, make the triangulation and run the method of the instance. False if jv is not an instance
+//or has an unknown method
+bool solve_instance(const value& jv, const Solve_options& options, Solve_result& result);
+
+//solve_instance through the result cache and write the solution to output_path. A cached solution good enough is
+//copied without a run, otherwise the best known solution of the instance is the warm start
+bool solve_to_file(const value& jv, const Solve_options& options, const std_string& output_path, Solve_result& result);
+
+//Batch mode: solve the instances of options.batch on options.num_jobs workers, while a loader thread reads the next
+//ones. One solution per instance goes to output_dir, with a summary table. Returns the number of failed instances
+int run_batch(const Solve_options& options, const std_string& output_dir);
+
+#endif
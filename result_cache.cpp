@@ -0,0 +1,213 @@
+#include "includes/utils/result_cache.h"
+
+#include <filesystem>
+#include <iomanip>
+
+using namespace boost::json;
+using namespace std;
+using std_string = std::string;
+namespace fs = std::filesystem;
+
+//The cache of this process, the batch workers share it
+static std_string cache_directory;
+static uintmax_t cache_max_bytes = 0;
+static std::mutex cache_mutex;
+
+void set_result_cache(const std_string& directory, uintmax_t max_bytes) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache_directory = directory;
+    cache_max_bytes = max_bytes;
+    if (directory.empty()) return;
+    std::error_code error_code;
+    fs::create_directories(directory, error_code);
+    if (error_code) {
+        cerr<<"Error: Could not create the cache "<<directory<<": "<<error_code.message()<<", no cache"<<endl;
+        cache_directory.clear();
+    }
+}
+
+bool result_cache_enabled() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return !cache_directory.empty();
+}
+
+//128 bits of FNV-1a (two 64 bit hashes from different offsets) in hex
+static std_string hash_text(const std_string& text) {
+    uint64_t first = 14695981039346656037ULL, second = 0x6c62272e07bb0142ULL;
+    for (unsigned char c : text) {
+        first = (first ^ c) * 1099511628211ULL;
+        second = (second ^ c) * 1099511628211ULL;
+    }
+    ostringstream oss;
+    oss<<hex<<setfill('0')<<setw(16)<<first<<setw(16)<<second;
+    return oss.str();
+}
+
+//Numbers as doubles, so 1 and 1.0 give the same key
+static void append_numbers(ostringstream& oss, const boost::json::array& numbers) {
+    for (const auto& number : numbers) oss<<number.to_number<double>()<<",";
+    oss<<";";
+}
+
+std_string instance_cache_key(const value& jv) {
+    const auto& obj = jv.as_object();
+    ostringstream oss;
+    oss<<setprecision(17);
+    append_numbers(oss, obj.at("points_x").as_array());
+    append_numbers(oss, obj.at("points_y").as_array());
+    append_numbers(oss, obj.at("region_boundary").as_array());
+    for (const auto& constraint : obj.at("additional_constraints").as_array()) append_numbers(oss, constraint.as_array());
+    return hash_text(oss.str());
+}
+
+std_string run_cache_key(const value& jv, const std_string& run_key) {
+    const auto& obj = jv.as_object();
+    ostringstream oss;
+    oss<<setprecision(17)<<instance_cache_key(jv)<<";"<<obj.at("method").as_string()<<";"<<obj.at("delaunay").as_bool()<<";";
+    //The parameters by name, the order of the file does not matter
+    vector<pair<std_string, std_string>> parameters;
+    for (const auto& parameter : obj.at("parameters").as_object()) {
+        ostringstream parameter_value;
+        if (parameter.value().is_number()) parameter_value<<setprecision(17)<<parameter.value().to_number<double>();
+        else parameter_value<<serialize(parameter.value());
+        parameters.emplace_back(std_string(parameter.key()), parameter_value.str());
+    }
+    sort(parameters.begin(), parameters.end());
+    for (const auto& parameter : parameters) oss<<parameter.first<<"="<<parameter.second<<",";
+    oss<<";"<<run_key;
+    return hash_text(oss.str());
+}
+
+std_string file_cache_key(const std_string& path) {
+    ifstream file(path, ios::binary);
+    if (!file) return hash_text(path);
+    return hash_text(std_string((istreambuf_iterator<char>(file)), istreambuf_iterator<char>()));
+}
+
+//The obtuses and the steiners of a cached solution, false if it is not there or cannot be read
+static bool read_entry(const std_string& path, Cache_entry& entry) {
+    std::error_code error_code;
+    if (!fs::exists(path, error_code)) return false;
+    try {
+        ifstream file(path);
+        std_string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        value parsed = parse(text);
+        const auto& obj = parsed.as_object();
+        const auto& obtuse_count = obj.at("obtuse_count");
+        entry.obtuses = obtuse_count.is_string() ? stoi(std_string(obtuse_count.as_string())) : obtuse_count.to_number<int>();
+        entry.steiners = obj.at("steiner_points_x").as_array().size();
+        entry.path = path;
+    }
+    catch (const exception& error) {
+        cerr<<"Error reading the cached solution "<<path<<": "<<error.what()<<endl;
+        return false;
+    }
+    return true;
+}
+
+//A hit makes the file the most recently used
+static void touch(const std_string& path) {
+    std::error_code error_code;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error_code);
+}
+
+static std_string run_path(const value& jv, const std_string& run_key) {
+    return (fs::path(cache_directory) / (run_cache_key(jv, run_key) + ".solution.json")).string();
+}
+
+static std_string best_path(const value& jv) {
+    return (fs::path(cache_directory) / (instance_cache_key(jv) + ".best.solution.json")).string();
+}
+
+bool cache_lookup(const value& jv, const std_string& run_key, Cache_entry& entry) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (cache_directory.empty()) return false;
+    std_string path = run_path(jv, run_key);
+    if (!read_entry(path, entry)) return false;
+    touch(path);
+    return true;
+}
+
+bool cache_best_known(const value& jv, Cache_entry& entry) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (cache_directory.empty()) return false;
+    std_string path = best_path(jv);
+    if (!read_entry(path, entry)) return false;
+    touch(path);
+    return true;
+}
+
+//Copy under a temporary name and rename, a reader never sees half a file
+static bool copy_into_cache(const std_string& from, const std_string& to) {
+    std::error_code error_code;
+    std_string temporary = to + ".tmp";
+    fs::copy_file(from, temporary, fs::copy_options::overwrite_existing, error_code);
+    if (!error_code) fs::rename(temporary, to, error_code);
+    if (error_code) {
+        cerr<<"Error: Could not write "<<to<<" in the cache: "<<error_code.message()<<endl;
+        fs::remove(temporary, error_code);
+        return false;
+    }
+    return true;
+}
+
+//Remove the least recently used solutions until the cache fits in its size, never the files of keep
+static void evict(const vector<std_string>& keep) {
+    std::error_code error_code;
+    vector<pair<fs::file_time_type, fs::path>> files;
+    uintmax_t total = 0;
+    for (const auto& file : fs::directory_iterator(cache_directory, error_code)) {
+        if (!file.is_regular_file(error_code)) continue;
+        total += file.file_size(error_code);
+        files.emplace_back(file.last_write_time(error_code), file.path());
+    }
+    if (total <= cache_max_bytes) return;
+    sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        if (total <= cache_max_bytes) break;
+        if (find(keep.begin(), keep.end(), file.second.string()) != keep.end()) continue;
+        uintmax_t size = fs::file_size(file.second, error_code);
+        if (fs::remove(file.second, error_code)) total -= size;
+    }
+}
+
+void cache_store(const value& jv, const std_string& run_key, const std_string& solution_path, bool complete) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (cache_directory.empty()) return;
+    Cache_entry solution, best;
+    if (!read_entry(solution_path, solution)) return;
+    std_string stored = run_path(jv, run_key);
+    //A stopped run (or one from the best known solution) is not the result of its parameters, it can still be the
+    //best known solution
+    if (complete) copy_into_cache(solution_path, stored);
+    std_string path = best_path(jv);
+    if (!read_entry(path, best) || solution.obtuses < best.obtuses ||
+        (solution.obtuses == best.obtuses && solution.steiners < best.steiners)) {
+        copy_into_cache(solution_path, path);
+    }
+    //The files of this instance and run stay, even when the run was not stored
+    if (cache_max_bytes > 0) evict({stored, path});
+}
+
+bool cache_copy_solution(const value& jv, const std_string& from, const std_string& to) {
+    ifstream input(from);
+    ostringstream text;
+    std_string line;
+    const std_string uid_line = "  \"instance_uid\": ";
+    while (getline(input, line)) {
+        //The line that output() writes for the instance_uid
+        if (line.compare(0, uid_line.size(), uid_line) == 0) line = uid_line + serialize(jv.as_object().at("instance_uid")) + ",";
+        text<<line<<"\n";
+    }
+    if (!input.eof()) {
+        cerr<<"Error: Could not read the cached solution "<<from<<endl;
+        return false;
+    }
+    ofstream output_file(to);
+    output_file<<text.str();
+    if (!output_file) {
+        cerr<<"Error: Could not write "<<to<<endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,166 @@
+#include "includes/utils/checkpoint.h"
+
+using namespace std;
+using Exact_FT = std::decay_t<decltype(CGAL::exact(FT()))>;
+using Exact_int = std::decay_t<decltype(Exact_FT().get_num())>;
+
+//The cap of this process, the workers of the searches read it
+static std::atomic<long long> max_snap_denominator(0);
+//Radii of the search around a steiner point: the size of its face divided by 4, 16, 64, ...
+const int SNAP_LEVELS = 8;
+
+void set_snap_denominator(long long max_denominator) {
+    max_snap_denominator = max(0LL, max_denominator);
+}
+
+long long snap_denominator() {
+    return max_snap_denominator;
+}
+
+static Exact_int floor_of(const Exact_FT& q) {
+    //The division of the integers truncates, the denominator is positive
+    Exact_int quotient = q.get_num() / q.get_den();
+    if (q < 0 && quotient * q.get_den() != q.get_num()) quotient -= 1;
+    return quotient;
+}
+
+//The rational with the smallest denominator in [low, high], built from its continued fraction. False when its
+//denominator is larger than max_denominator (a smaller interval only gives larger denominators)
+static bool simplest_between(Exact_FT low, Exact_FT high, const Exact_int& max_denominator, Exact_FT& simplest) {
+    //The last two convergents
+    Exact_int h1 = 1, h2 = 0, k1 = 0, k2 = 1;
+    while (true) {
+        Exact_int a = floor_of(low);
+        //An integer in the interval ends the fraction
+        bool last = Exact_FT(a) == low || floor_of(high) > a;
+        if (last && Exact_FT(a) != low) a += 1;
+        Exact_int h = a * h1 + h2, k = a * k1 + k2;
+        if (k > max_denominator) return false;
+        if (last) {
+            simplest = Exact_FT(h, k);
+            simplest.canonicalize();
+            return true;
+        }
+        h2 = h1;
+        h1 = h;
+        k2 = k1;
+        k1 = k;
+        //low and high are in (a, a + 1), continue with the fractional parts inverted
+        Exact_FT next_low = 1 / (high - a);
+        high = 1 / (low - a);
+        low = next_low;
+    }
+}
+
+size_t coordinate_bits(const FT& coord) {
+    const auto exact_coord = CGAL::exact(coord);
+    return mpz_sizeinbase(exact_coord.get_num().get_mpz_t(), 2) + mpz_sizeinbase(exact_coord.get_den().get_mpz_t(), 2);
+}
+
+static size_t point_bits(const Point_2& p) {
+    return coordinate_bits(p.x()) + coordinate_bits(p.y());
+}
+
+Coordinate_bits steiner_coordinate_bits(const Custom_CDT& cdt) {
+    Coordinate_bits bits;
+    for (auto vertex = cdt.finite_vertices_begin(); vertex != cdt.finite_vertices_end(); ++vertex) {
+        if (!is_steiner_point(vertex)) continue;
+        for (const FT& coord : {vertex->point().x(), vertex->point().y()}) {
+            size_t coord_bits = coordinate_bits(coord);
+            bits.coordinates++;
+            bits.total += coord_bits;
+            bits.max = max(bits.max, coord_bits);
+        }
+    }
+    return bits;
+}
+
+static bool strictly_inside(const Face_handle& face, const Point_2& p) {
+    CGAL::Triangle_2<K> triangle(face->vertex(0)->point(), face->vertex(1)->point(), face->vertex(2)->point());
+    return triangle.bounded_side(p) == CGAL::ON_BOUNDED_SIDE;
+}
+
+static bool snap_point(const Custom_CDT& cdt, const Polygon& polygon, Point_2& steiner_point, long long max_denominator) {
+    if (max_denominator <= 0 || cdt.dimension() < 2) return false;
+    //The faces where the snapped point may go: the face of the point, or the two faces of its edge. A point on a
+    //constraint (or on the region boundary) stays where it is
+    Custom_CDT::Locate_type location;
+    int li;
+    Face_handle face = cdt.locate(steiner_point, location, li);
+    vector<Face_handle> targets;
+    if (location == Custom_CDT::FACE) targets.push_back(face);
+    else if (location == Custom_CDT::EDGE && !cdt.is_constrained(Custom_CDT::Edge(face, li))) {
+        targets.push_back(face);
+        targets.push_back(face->neighbor(li));
+    }
+    double extent = 0.0;
+    for (auto target = targets.begin(); target != targets.end();) {
+        if (cdt.is_infinite(*target) || !Custom_CDT::is_in_domain(*target)) {
+            target = targets.erase(target);
+            continue;
+        }
+        CGAL::Bbox_2 box = (*target)->vertex(0)->point().bbox() + (*target)->vertex(1)->point().bbox() +
+                           (*target)->vertex(2)->point().bbox();
+        extent = max(extent, max(box.xmax() - box.xmin(), box.ymax() - box.ymin()));
+        ++target;
+    }
+    if (targets.empty() || extent <= 0.0) return false;
+    //An integer point is already the simplest
+    if (CGAL::exact(steiner_point.x()).get_den() == 1 && CGAL::exact(steiner_point.y()).get_den() == 1) return false;
+    size_t bits = point_bits(steiner_point);
+    Insertion_delta before = evaluate_steiner(cdt, polygon, steiner_point);
+    if (!before.valid) return false;
+
+    //From the largest radius (the simplest point) down, the first point that keeps the obtuse result
+    Exact_int max_den = static_cast<long>(max_denominator);
+    double radius = extent / 4;
+    for (int level = 0; level < SNAP_LEVELS; ++level, radius /= 4) {
+        FT r(radius);
+        Exact_FT x, y;
+        if (!simplest_between(CGAL::exact(steiner_point.x() - r), CGAL::exact(steiner_point.x() + r), max_den, x)) break;
+        if (!simplest_between(CGAL::exact(steiner_point.y() - r), CGAL::exact(steiner_point.y() + r), max_den, y)) break;
+        Point_2 snapped(FT(x), FT(y));
+        if (snapped == steiner_point || point_bits(snapped) >= bits) return false;
+        bool inside = false;
+        for (const Face_handle& target : targets) inside = inside || strictly_inside(target, snapped);
+        if (!inside) continue;
+        Insertion_delta after = evaluate_steiner(cdt, polygon, snapped);
+        if (!after.valid || after.obtuse_delta > before.obtuse_delta) continue;
+        steiner_point = snapped;
+        return true;
+    }
+    return false;
+}
+
+bool snap_steiner_point(const Custom_CDT& cdt, const Polygon& polygon, Point_2& steiner_point) {
+    return snap_point(cdt, polygon, steiner_point, snap_denominator());
+}
+
+bool simplify_steiner_points(const Custom_CDT& base_cdt, const Polygon& base_polygon, Custom_CDT& cdt, Polygon& polygon) {
+    long long max_denominator = snap_denominator() > 0 ? snap_denominator() : DEFAULT_SNAP_DENOMINATOR;
+    vector<Point_2> steiners = steiner_points_in_order(cdt);
+    Coordinate_bits bits_before = steiner_coordinate_bits(cdt);
+    Custom_CDT simplified_cdt = base_cdt;
+    Polygon simplified_polygon = base_polygon;
+    int snapped = 0;
+    for (Point_2 steiner_point : steiners) {
+        if (snap_point(simplified_cdt, simplified_polygon, steiner_point, max_denominator)) snapped++;
+        bool on_boundary = simplified_polygon.bounded_side(steiner_point) == CGAL::ON_BOUNDARY;
+        start_the_flips(simplified_cdt, simplified_polygon, simplified_cdt.insert_no_flip(steiner_point));
+        if (on_boundary) update_polygon(simplified_polygon, steiner_point);
+    }
+    int obtuses = count_obtuse_triangles(cdt, polygon);
+    int simplified_obtuses = count_obtuse_triangles(simplified_cdt, simplified_polygon);
+    Coordinate_bits bits_after = steiner_coordinate_bits(simplified_cdt);
+    cout<<"Simplify steiners: "<<snapped<<" of "<<steiners.size()<<" snapped, coordinate bits mean "<<bits_before.mean()
+        <<" -> "<<bits_after.mean()<<", max "<<bits_before.max<<" -> "<<bits_after.max<<", obtuses "<<obtuses
+        <<" -> "<<simplified_obtuses<<endl;
+    //The insertions again in one order may flip otherwise than the search did
+    if (snapped == 0 || simplified_obtuses > obtuses || simplified_cdt.number_of_vertices() != cdt.number_of_vertices()) {
+        cout<<"Simplify steiners: the original steiners are kept"<<endl;
+        return false;
+    }
+    cdt = simplified_cdt;
+    polygon = simplified_polygon;
+    return true;
+}
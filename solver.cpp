@@ -0,0 +1,651 @@
+#include "includes/utils/solver.h"
+#include "includes/utils/functions_task1.h"
+#include "includes/utils/checkpoint.h"
+#include "includes/utils/result_cache.h"
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <glob.h>
+#include <iomanip>
+
+using namespace boost::json;
+using namespace std;
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using CDT = CGAL::Constrained_Delaunay_triangulation_2<K>;
+using Point = CDT::Point;
+using Custom_CDT = Custom_Constrained_Delaunay_triangulation_2<K>;
+using Point_2 = K::Point_2;
+using Vertex_handle = Custom_CDT::Vertex_handle;
+using std_string = std::string;
+
+//Read the options of the command line (-i input -o output and the ones of Solve_options). False if they are wrong
+bool parse_arguments(int argc, char** argv, std_string& input_path, std_string& output_path, Solve_options& options) {
+    //Parse command-line arguments
+    for (int i = 1; i < argc; ++i) {
+        
+        if (std_string(argv[i]) == "-i" && i + 1 < argc) {
+            input_path = argv[++i];
+        }
+        else if (std_string(argv[i]) == "-o" && i + 1 < argc) {
+            output_path = argv[++i];
+        }
+        else if (std_string(argv[i]) == "-auto") {
+            options.run_auto_method = true; 
+        }
+        //Worker threads of local search and ant colony
+        else if (std_string(argv[i]) == "-threads" && i + 1 < argc) {
+            options.num_threads = atoi(argv[++i]);
+            if (options.num_threads < 1) {
+                cerr<<"The number of threads must be at least 1."<<endl;
+                return false;
+            }
+        }
+        //Independent chains of simulated annealing, one thread each
+        else if (std_string(argv[i]) == "-chains" && i + 1 < argc) {
+            options.num_chains = atoi(argv[++i]);
+            if (options.num_chains < 1) {
+                cerr<<"The number of chains must be at least 1."<<endl;
+                return false;
+            }
+        }
+        //Parallel tempering in place of simulated annealing, one thread for every temperature
+        else if (std_string(argv[i]) == "-replicas" && i + 1 < argc) {
+            options.num_replicas = atoi(argv[++i]);
+            if (options.num_replicas < 1) {
+                cerr<<"The number of replicas must be at least 1."<<endl;
+                return false;
+            }
+        }
+        //Batch mode, -o is the output directory
+        else if (std_string(argv[i]) == "-batch" && i + 1 < argc) {
+            options.batch = argv[++i];
+        }
+        else if (std_string(argv[i]) == "-jobs" && i + 1 < argc) {
+            options.num_jobs = atoi(argv[++i]);
+            if (options.num_jobs < 1) {
+                cerr<<"The number of jobs must be at least 1."<<endl;
+                return false;
+            }
+        }
+        //Time limits, the searches return their best triangulation when the time is up
+        else if (std_string(argv[i]) == "-time-limit" && i + 1 < argc) {
+            options.time_limit = atof(argv[++i]);
+        }
+        else if (std_string(argv[i]) == "-total-time-limit" && i + 1 < argc) {
+            options.total_time_limit = atof(argv[++i]);
+        }
+        //Checkpoints of the search state, and continue a stopped run from its checkpoint
+        else if (std_string(argv[i]) == "-checkpoint" && i + 1 < argc) {
+            options.checkpoint_path = argv[++i];
+        }
+        else if (std_string(argv[i]) == "-checkpoint-interval" && i + 1 < argc) {
+            options.checkpoint_interval = atof(argv[++i]);
+        }
+        else if (std_string(argv[i]) == "-resume") {
+            options.resume = true;
+        }
+        //Start from the steiner points of an earlier solution
+        else if (std_string(argv[i]) == "-warm-start" && i + 1 < argc) {
+            options.warm_start = argv[++i];
+        }
+        //Result cache
+        else if (std_string(argv[i]) == "-cache" && i + 1 < argc) {
+            options.cache_dir = argv[++i];
+        }
+        else if (std_string(argv[i]) == "-cache-size" && i + 1 < argc) {
+            options.cache_size_mb = atof(argv[++i]);
+        }
+        else if (std_string(argv[i]) == "-target-obtuses" && i + 1 < argc) {
+            options.target_obtuses = atoi(argv[++i]);
+        }
+        //Explore in doubles, insert in exact arithmetic
+        else if (std_string(argv[i]) == "-dual-kernel") {
+            options.dual_kernel = true;
+        }
+        //Simpler rational steiner coordinates
+        else if (std_string(argv[i]) == "-snap-denominator" && i + 1 < argc) {
+            options.snap_denominator = atoll(argv[++i]);
+        }
+        else if (std_string(argv[i]) == "-simplify-steiners") {
+            options.simplify_steiners = true;
+        }
+        //All the random generators from this seed, a run on one thread can be repeated
+        else if (std_string(argv[i]) == "-seed" && i + 1 < argc) {
+            options.seed = strtoul(argv[++i], nullptr, 10);
+            options.has_seed = true;
+            set_random_seed(options.seed);
+        }
+    }
+
+    if (!options.batch.empty() && output_path.empty()) {
+        cerr<<"Empty output directory."<<endl;
+        cout<<"Check this pattern of terminal order: ./opt_triangulation -batch /path/to/instances -o /path/to/output_dir -jobs N"<<endl;
+        return false;
+    }
+    if (options.batch.empty() && (input_path.empty() || output_path.empty())) {
+        cerr<<"Empty input path or output path."<<endl;
+        cout<<"Check this pattern of terminal order: ./opt_triangulation -i /path/to/input.json -o /path/to/output.json"<<endl;
+        return false;
+    }
+    //The checkpoint goes next to the output (in batch mode next to every solution)
+    if (options.batch.empty() && options.checkpoint_path.empty() && (options.checkpoint_interval > 0 || options.resume)) {
+        options.checkpoint_path = output_path + ".checkpoint.json";
+    }
+    if (!options.checkpoint_path.empty() && options.checkpoint_interval <= 0) options.checkpoint_interval = 60.0;
+    //The sweeps of the scripts use the cache without an option
+    if (options.cache_dir.empty() && getenv("OPT_TRIANGULATION_CACHE")) options.cache_dir = getenv("OPT_TRIANGULATION_CACHE");
+    set_result_cache(options.cache_dir, static_cast<uintmax_t>(max(0.0, options.cache_size_mb) * 1024 * 1024));
+    set_dual_kernel(options.dual_kernel);
+    set_snap_denominator(options.snap_denominator);
+    return true;
+}
+
+//A coordinate of a solution: a number, or a string as convert_to_string writes it ("n" or "n/d")
+FT solution_coordinate(const value& coord) {
+    if (coord.is_string()) return convert_from_string(std_string(coord.as_string()));
+    if (coord.is_int64()) return FT(coord.as_int64());
+    return FT(coord.to_number<double>());
+}
+
+//The steiner points of the solution file path for the instance instance_uid. False if the file cannot be read or is
+//the solution of another instance
+bool read_warm_start(const std_string& path, const std_string& instance_uid, vector<Point_2>& steiner_points) {
+    try {
+        value sv;
+        read_json(path, sv);
+        if (!sv.is_object()) return false;
+        const auto& obj = sv.as_object();
+        if (obj.contains("instance_uid") && std_string(obj.at("instance_uid").as_string()) != instance_uid) {
+            cerr<<"The solution "<<path<<" is of the instance "<<obj.at("instance_uid").as_string()<<", not of "
+                <<instance_uid<<endl;
+            return false;
+        }
+        const auto& x_array = obj.at("steiner_points_x").as_array();
+        const auto& y_array = obj.at("steiner_points_y").as_array();
+        if (x_array.size() != y_array.size()) throw logic_error("different number of x and y coordinates");
+        for (size_t i = 0; i < x_array.size(); ++i) {
+            steiner_points.emplace_back(solution_coordinate(x_array[i]), solution_coordinate(y_array[i]));
+        }
+    }
+    catch (const exception& error) {
+        cerr<<"Error reading the solution "<<path<<": "<<error.what()<<endl;
+        return false;
+    }
+    return true;
+}
+
+//Read the instance, make its triangulation and run its method (phases 1 and 2 of the program)
+bool solve_instance(const value& jv, const Solve_options& options, Solve_result& result) {
+
+    //The deadline of this instance, for the searches of this thread (and of their workers)
+    set_instance_time_limit(options.time_limit);
+    bool run_Simulated_Annealing = false, run_Local_Search = false, run_Ant_Colony = false;
+    bool run_auto_method = options.run_auto_method;
+    bool has_constraints= false, is_polygon_convex = false, has_closed_constraints = false, has_open_constraints = false;
+    bool has_boundary_straight_lines = false, unspecified = false;
+    double alpha = 2.2, beta = 0.1, chi = 3.0, psi = 1.0, lamda = 0.5, kappa = 5;
+    int L = 1230, batch_size = 5;
+    vector<int> my_methods = {0,1,2,3,4};
+    Custom_CDT custom_cdt;
+    vector<Point_2> points;
+    vector<pair<int, int>> additional_constraints;
+    vector<int> region_boundary;
+    Polygon polygon;
+    Polygon simulated_polygon;
+    std_string method, instance_uid;
+    bool delaunay = true;
+
+//////////// PHASE 1: INITIALIZATION //////////////////////////////
+    
+    if (jv.is_object()) {
+        const auto& obj = jv.as_object();
+        const auto& x_array = obj.at("points_x").as_array();
+        const auto& y_array = obj.at("points_y").as_array();
+        const auto& boundary_array = obj.at("region_boundary").as_array();
+        const auto& constraints_array = obj.at("additional_constraints").as_array();
+        method = std_string(obj.at("method").as_string());
+        instance_uid = std_string(obj.at("instance_uid").as_string());
+        const auto& parameters_obj = obj.at("parameters").as_object();
+        delaunay = obj.at("delaunay").as_bool();
+
+        //Output method and delaunay
+        L = parameters_obj.at("L").as_int64();
+        
+        //Chosen method
+        if(method == "local") {
+            run_Local_Search = true;
+            alpha = parameters_obj.at("alpha").as_double();
+            beta = parameters_obj.at("beta").as_double();
+        }
+        else if(method == "sa") {
+            run_Simulated_Annealing = true;
+            alpha = parameters_obj.at("alpha").as_double();
+            beta = parameters_obj.at("beta").as_double();
+            //How many "bad" steiners we accept to insert, until we will try again to add steiners in the best_cdt
+            batch_size = parameters_obj.at("batch_size").as_int64();
+        }
+        else if(method == "ant"){
+            run_Ant_Colony = true;
+            
+            alpha = parameters_obj.at("alpha").as_double();
+            beta = parameters_obj.at("beta").as_double();
+            lamda = parameters_obj.at("lambda").as_double();
+            chi = parameters_obj.at("xi").as_double();
+            psi = parameters_obj.at("psi").as_double();
+            kappa = parameters_obj.at("kappa").as_int64();
+        }
+        else if(method == "auto"){
+            run_auto_method = true;
+            run_Simulated_Annealing = true;
+            alpha = parameters_obj.at("alpha").as_double();
+            beta = parameters_obj.at("beta").as_double();
+            //How many "bad" steiners we accept to insert, until we will try again to add steiners in the best_cdt
+            batch_size = parameters_obj.at("batch_size").as_int64();
+            my_methods = {0,1,2,3,4};
+        }
+        else {
+            cerr<<"Error: wrong method"<<endl;
+            return false;
+        }
+
+        for (int i = 0; i < x_array.size(); ++i) {
+            double x = x_array[i].is_double() ? x_array[i].as_double() : static_cast<double>(x_array[i].as_int64());
+            double y = y_array[i].is_double() ? y_array[i].as_double() : static_cast<double>(y_array[i].as_int64());
+            points.emplace_back(x, y);
+        }
+
+        for (const auto& idx : boundary_array) {
+            region_boundary.push_back(idx.as_int64());
+        }
+        
+        //Add the additional constraints in vector
+        for (const auto& constraint : constraints_array) {
+            int idx1 = constraint.as_array()[0].as_int64();
+            int idx2 = constraint.as_array()[1].as_int64();
+            if (idx1 < points.size() && idx2 < points.size()) {
+                additional_constraints.emplace_back(idx1, idx2);
+            }
+        }
+
+        //Create a polygon from region boundary
+        for (int index : region_boundary) {
+            polygon.push_back(points[index]);
+        }
+        //Grid over the boundary edges, it answers the point in polygon tests of the polygon (and of its copies)
+        polygon.build_region_index();
+
+         // Insert region boundary as constraints
+        for (size_t i = 0; i < region_boundary.size(); ++i) {
+            int idx1 = region_boundary[i];
+            int idx2 = region_boundary[(i + 1) % region_boundary.size()]; // Wrap around to form a loop
+            custom_cdt.insert_constraint(points[idx1], points[idx2]);
+        }
+
+        //Make the cdt, every vertex of an input point keeps its index (the boundary points are already vertices)
+        for (int i = 0; i < points.size(); ++i) {
+            custom_cdt.insert_input_point(points[i], i);
+        }
+
+        //Insert additional constraints
+        for (const auto& constraint : additional_constraints) {
+            custom_cdt.insert_constraint(points[constraint.first], points[constraint.second]);
+        }
+
+        //From now on the cdt keeps the number of obtuse faces inside the region up to date
+        custom_cdt.set_region(polygon);
+
+        //Check if the polygon is convex (3rd Task)
+        if(polygon.is_convex()) is_polygon_convex = true;
+        //Check if the polygon (boundary) has straight lines (3rd Task)
+        if(boundary_straight_lines(polygon)) has_boundary_straight_lines = true;
+        if(!additional_constraints.empty()) has_constraints = true;
+
+        //3rd Task
+        if(!has_constraints && !is_polygon_convex && !has_boundary_straight_lines) unspecified = true;
+                
+        //Check if the instance has opened or closed constraints
+        if(has_constraints){
+            if(are_constraints_closed(additional_constraints, points.size(), points, polygon)) has_closed_constraints = true;
+            //If has not closed constraints and we have constraint, so we have open constraints
+            else has_open_constraints = true;
+        }
+    }
+    else {
+        cerr<<"Jv is not object: safe exit"<<endl;
+        return false;
+    }
+
+    std_string category = "Null";
+    if(is_polygon_convex && !has_constraints){
+        //category = "CONVEX_NO_CONSTRAINTS";
+        category ="A";
+    }
+    if(is_polygon_convex && has_open_constraints){
+        //category = "CONVEX_OPEN_CONSTRAINTS";
+        category ="B";
+    }
+    if(is_polygon_convex && has_closed_constraints){
+        //category = "CONVEX_CLOSED_CONSTRAINTS";
+        category ="C";
+    }
+    if(!is_polygon_convex && has_boundary_straight_lines){
+        //category = "NOT_CONVEX_PARALLEL_N0_CONSTRAINTS";
+        category ="D";
+    }
+    if(!is_polygon_convex && unspecified){
+        //category = "UNSPECIFIED_BOUNDARY";
+        category ="E";
+    }
+    //This vector return array of arrays like [2], [0,2], [0,1,2]..
+    vector<vector<int>> subsets = generateSubsetsWith2(0, 4);    
+    //Checkpoints of this instance, with -resume the search continues from the checkpoint
+    set_checkpoint_file(options.checkpoint_path, options.checkpoint_interval, options.resume, instance_uid);
+    const Checkpoint* resume = loaded_checkpoint();
+    vector<Point_2> warm_steiners;
+    //////////// PHASE 2: FLIPS & STEINER POINTS //////////////////////////////
+    int obtuses_faces = count_obtuse_triangles(custom_cdt, polygon);
+    int init_obtuse_faces = obtuses_faces;
+    int initial_vertexes = custom_cdt.number_of_vertices();
+    cout<<"Initial number of obtuses: "<<init_obtuse_faces<<endl;
+    cout<<"Initial number of vertexes: "<<custom_cdt.number_of_vertices()<<endl;
+    //CGAL::draw(custom_cdt);
+    double success;
+    bool randomization = false;
+    //Start the flips before copy simulated cdt
+    //start_the_flips(custom_cdt, polygon);
+
+    Custom_CDT simulated_cdt = custom_cdt;
+    simulated_polygon = polygon;   
+    if(resume) {
+        //The steiner points of the checkpoint in their order, the region as the checkpoint left it
+        for (const Point_2& steiner : resume->steiner_points) {
+            start_the_flips(simulated_cdt, simulated_polygon, simulated_cdt.insert_no_flip(steiner));
+        }
+        simulated_polygon = Polygon(resume->polygon.begin(), resume->polygon.end());
+        simulated_polygon.build_region_index();
+        cout<<"Resume from the checkpoint ("<<resume->engine<<", "<<resume->steiner_points.size()<<" steiners, "
+            <<count_obtuse_triangles(simulated_cdt, simulated_polygon)<<" obtuses)"<<endl;
+    }
+    //Warm start, the search continues from the steiner points of the solution (in place of task1)
+    else if(!options.warm_start.empty() && read_warm_start(options.warm_start, instance_uid, warm_steiners)) {
+        int inserted = insert_steiner_points(simulated_cdt, simulated_polygon, warm_steiners);
+        cout<<"Warm start from "<<options.warm_start<<": "<<inserted<<" steiners, "
+            <<count_obtuse_triangles(simulated_cdt, simulated_polygon)<<" obtuses"<<endl;
+    }
+    //Run task1 if delaunay parameter is false
+    else if(!delaunay) {
+        cout<<"**Run task1**"<<endl;
+        run_task1(simulated_cdt, polygon);
+        obtuses_faces = count_obtuse_triangles(simulated_cdt, polygon);
+        cout<<"Number of obtuses after task 1: "<<obtuses_faces<<endl;
+        cout<<"Sum of steiners after task 1: "<<count_vertices(simulated_cdt) - initial_vertexes<<endl;
+        if(init_obtuse_faces > 0) success = ((double)obtuses_faces/(double)init_obtuse_faces)*100;
+        cout<<100-success<<"%"<<" obtuse triangles reduction success after task 1"<<endl;
+    }
+    //Local Search
+    if(run_Local_Search){
+        cout<<"Local Search is starting.."<<endl;
+        local_search(simulated_cdt, simulated_polygon, L, instance_uid, randomization, alpha, beta, my_methods, category,
+                        run_auto_method, options.num_threads);
+        cout<<"**Number of Obtuses after from Local Search: "<<
+            count_obtuse_triangles(simulated_cdt, simulated_polygon)<<" **"<<endl;
+    }
+    //SA
+    if(run_Simulated_Annealing){
+        cout<<"Simulated Annealing is starting.. "<<endl;
+        if (options.num_replicas > 1) {
+            parallel_tempering(simulated_cdt, simulated_polygon, L, alpha, beta, batch_size, instance_uid, randomization, 
+                my_methods, category, run_auto_method, options.num_replicas);
+        }
+        else {
+            simulated_annealing(simulated_cdt, simulated_polygon, L, alpha, beta, batch_size, instance_uid, randomization, 
+                my_methods, category, run_auto_method, options.num_chains);
+        }
+        cout<<"**Number of Obtuses after from Simulated Annealing: "<<
+            count_obtuse_triangles(simulated_cdt, simulated_polygon)<<" **"<<endl;
+    }
+    //Ant Colony
+    if(run_Ant_Colony){
+        cout<<"Ant Colony is starting.. "<<endl;
+        ant_colony(simulated_cdt, simulated_polygon, alpha, beta, chi, psi, lamda , L, kappa, instance_uid, randomization,
+            my_methods, category, run_auto_method, options.num_threads);
+        cout<<"**Number of Obtuses after from Ant Colony: "<<
+            count_obtuse_triangles(simulated_cdt, simulated_polygon)<<" **"<<endl;
+    }
+    //Post-pass, the steiners again from the cdt before any steiner with simpler coordinates
+    if(options.simplify_steiners) simplify_steiner_points(custom_cdt, polygon, simulated_cdt, simulated_polygon);
+    
+    obtuses_faces = count_obtuse_triangles(simulated_cdt, simulated_polygon);
+    cout<<"Final obtuses faces: "<<obtuses_faces<<endl;
+    cout<<"Sum of steiners: "<<simulated_cdt.number_of_vertices() - initial_vertexes<<endl;
+    cout<<"Final number of vertexes: "<<simulated_cdt.number_of_vertices()<<endl;
+    cout<<"Flips attempted: "<<simulated_cdt.flip_statistics().attempted<<
+        " applied: "<<simulated_cdt.flip_statistics().applied<<endl;
+    if(init_obtuse_faces > 0) success = ((double)obtuses_faces/(double)init_obtuse_faces)*100;
+    cout<<100-success<<"%"<<" obtuse triangles reduction success"<<endl;
+    cout<<"Final form of Custom CDT "<<endl;
+
+    result.instance_uid = instance_uid;
+    result.method = method;
+    result.category = category;
+    result.points = points;
+    result.polygon = polygon;
+    result.cdt = simulated_cdt;
+    result.init_obtuses = init_obtuse_faces;
+    result.final_obtuses = obtuses_faces;
+    result.num_steiners = simulated_cdt.number_of_vertices() - initial_vertexes;
+    result.alpha = alpha;
+    result.beta = beta;
+    result.energy = calculate_energy(obtuses_faces, result.num_steiners, alpha, beta);
+    result.randomization = randomization;
+    result.coordinate_bits = steiner_coordinate_bits(simulated_cdt);
+    cout<<"Steiner coordinate bits: mean "<<result.coordinate_bits.mean()<<", max "<<result.coordinate_bits.max<<endl;
+    return true;
+}
+
+
+//The options that change the search, part of the cache key of a run
+std_string run_options_key(const Solve_options& options) {
+    return "auto=" + to_string(options.run_auto_method) + ",threads=" + to_string(options.num_threads) + 
+           ",chains=" + to_string(options.num_chains) + ",replicas=" + to_string(options.num_replicas) +
+           ",dual_kernel=" + to_string(options.dual_kernel) + ",snap=" + to_string(options.snap_denominator) +
+           ",simplify=" + to_string(options.simplify_steiners) + 
+           ",seed=" + (options.has_seed ? to_string(options.seed) : std_string("random")) +
+           //The solution the run starts from, by its content
+           (options.warm_start.empty() ? std_string() : ",warm_start=" + file_cache_key(options.warm_start));
+}
+
+bool solve_to_file(const value& jv, const Solve_options& options, const std_string& output_path, Solve_result& result) {
+    if (!result_cache_enabled() || !jv.is_object()) {
+        if (!solve_instance(jv, options, result)) return false;
+        output(jv, result.cdt, result.points, result.final_obtuses, output_path, result.randomization);
+        return true;
+    }
+    std_string run_key = run_options_key(options);
+    Cache_entry entry;
+    if (!options.resume && cache_lookup(jv, run_key, entry) && 
+        (options.target_obtuses < 0 || entry.obtuses <= options.target_obtuses)) {
+        if (cache_copy_solution(jv, entry.path, output_path)) {
+            const auto& obj = jv.as_object();
+            const auto& parameters_obj = obj.at("parameters").as_object();
+            result.instance_uid = std_string(obj.at("instance_uid").as_string());
+            result.method = std_string(obj.at("method").as_string());
+            result.final_obtuses = entry.obtuses;
+            result.num_steiners = entry.steiners;
+            result.alpha = parameters_obj.contains("alpha") ? parameters_obj.at("alpha").to_number<double>() : 0.0;
+            result.beta = parameters_obj.contains("beta") ? parameters_obj.at("beta").to_number<double>() : 0.0;
+            result.energy = calculate_energy(result.final_obtuses, result.num_steiners, result.alpha, result.beta);
+            result.cached = true;
+            cout<<"Cached solution of "<<result.instance_uid<<": "<<entry.obtuses<<" obtuses, "<<entry.steiners
+                <<" steiners"<<endl;
+            return true;
+        }
+    }
+    //The best known solution changes from run to run, a run that starts from it is not the result of its options
+    //and is kept only as a candidate for the best known solution (as a run cut by a time limit or a signal)
+    Solve_options run_options = options;
+    bool best_known_start = false;
+    //It may be of another instance with the same geometry, the run reads it from output_path with its instance_uid
+    if (run_options.warm_start.empty() && !options.resume && cache_best_known(jv, entry) &&
+        cache_copy_solution(jv, entry.path, output_path)) {
+        run_options.warm_start = output_path;
+        best_known_start = true;
+    }
+    if (!solve_instance(jv, run_options, result)) return false;
+    output(jv, result.cdt, result.points, result.final_obtuses, output_path, result.randomization);
+    cache_store(jv, run_key, output_path, !search_should_stop() && !best_known_start);
+    return true;
+}
+
+//The json files of a directory, or the files of a glob pattern, sorted
+vector<std_string> batch_files(const std_string& pattern) {
+    vector<std_string> files;
+    if (std::filesystem::is_directory(pattern)) {
+        for (const auto& entry : std::filesystem::directory_iterator(pattern)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".json") files.push_back(entry.path().string());
+        }
+    }
+    else {
+        glob_t matches;
+        if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; ++i) files.push_back(matches.gl_pathv[i]);
+        }
+        globfree(&matches);
+    }
+    sort(files.begin(), files.end());
+    return files;
+}
+
+//The solution file of an instance file: name.instance.json -> output_dir/name.solution.json
+std_string batch_output_path(const std_string& file, const std_string& output_dir) {
+    std_string name = std::filesystem::path(file).stem().string();
+    const std_string suffix = ".instance";
+    if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        name.erase(name.size() - suffix.size());
+    }
+    return (std::filesystem::path(output_dir) / (name + ".solution.json")).string();
+}
+
+int run_batch(const Solve_options& options, const std_string& output_dir) {
+    struct Batch_entry {
+        std_string file, instance_uid, method, status = "not run";
+        int init_obtuses = 0, final_obtuses = 0, num_steiners = 0;
+        double energy = 0.0, seconds = 0.0;
+        Coordinate_bits coordinate_bits;
+    };
+    vector<std_string> files = batch_files(options.batch);
+    if (files.empty()) {
+        cerr<<"No instances match "<<options.batch<<endl;
+        return 1;
+    }
+    std::error_code error_code;
+    std::filesystem::create_directories(output_dir, error_code);
+    if (error_code) {
+        cerr<<"Error: Could not create "<<output_dir<<": "<<error_code.message()<<endl;
+        return 1;
+    }
+    vector<Batch_entry> entries(files.size());
+    for (size_t i = 0; i < files.size(); ++i) entries[i].file = files[i];
+    cout<<"Batch of "<<files.size()<<" instances on "<<options.num_jobs<<" jobs"<<endl;
+
+    //The loader parses the instances in order, at most num_jobs of them wait in the queue
+    std::mutex queue_mutex;
+    std::condition_variable queue_changed;
+    std::deque<pair<size_t, value>> parsed;
+    bool loaded = false;
+    thread loader([&]() {
+        for (size_t i = 0; i < files.size(); ++i) {
+            value jv;
+            try {
+                read_json(files[i], jv);
+            }
+            catch (const exception& error) {
+                cerr<<"Error parsing "<<files[i]<<": "<<error.what()<<endl;
+                jv = value();
+            }
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_changed.wait(lock, [&]() { return parsed.size() < static_cast<size_t>(options.num_jobs); });
+            parsed.emplace_back(i, std::move(jv));
+            queue_changed.notify_all();
+        }
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        loaded = true;
+        queue_changed.notify_all();
+    });
+
+    vector<thread> workers;
+    for (int job = 0; job < options.num_jobs; ++job) {
+        workers.emplace_back([&]() {
+            while (true) {
+                pair<size_t, value> next;
+                {
+                    std::unique_lock<std::mutex> lock(queue_mutex);
+                    queue_changed.wait(lock, [&]() { return !parsed.empty() || loaded; });
+                    if (parsed.empty()) return;
+                    next = std::move(parsed.front());
+                    parsed.pop_front();
+                    queue_changed.notify_all();
+                }
+                Batch_entry& entry = entries[next.first];
+                //After a signal or the time limit of the run, the rest of the instances are not solved
+                if (run_should_stop()) {
+                    entry.status = "stopped";
+                    continue;
+                }
+                auto start = chrono::steady_clock::now();
+                try {
+                    Solve_result result;
+                    Solve_options instance_options = options;
+                    if (options.checkpoint_interval > 0 || options.resume) {
+                        instance_options.checkpoint_path = batch_output_path(entry.file, output_dir) + ".checkpoint.json";
+                    }
+                    //A directory of warm starts holds the solutions with the names of the output
+                    if (std::filesystem::is_directory(options.warm_start)) {
+                        instance_options.warm_start = batch_output_path(entry.file, options.warm_start);
+                        if (!std::filesystem::exists(instance_options.warm_start)) instance_options.warm_start.clear();
+                    }
+                    if (!solve_to_file(next.second, instance_options, batch_output_path(entry.file, output_dir), result)) {
+                        entry.status = "invalid instance";
+                    }
+                    else {
+                        entry.instance_uid = result.instance_uid;
+                        entry.method = result.method;
+                        entry.init_obtuses = result.init_obtuses;
+                        entry.final_obtuses = result.final_obtuses;
+                        entry.num_steiners = result.num_steiners;
+                        entry.energy = result.energy;
+                        entry.coordinate_bits = result.coordinate_bits;
+                        entry.status = result.cached ? "cached" : "ok";
+                    }
+                }
+                catch (const exception& error) {
+                    entry.status = std_string("error: ") + error.what();
+                }
+                entry.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            }
+        });
+    }
+    loader.join();
+    for (thread& worker : workers) worker.join();
+
+    //Summary table, on the screen and in output_dir/summary.csv
+    int failed = 0;
+    ofstream summary((std::filesystem::path(output_dir) / "summary.csv").string());
+    summary<<"instance,method,init_obtuses,final_obtuses,steiners,energy,seconds,mean_bits,max_bits,status"<<endl;
+    cout<<left<<setw(48)<<"instance"<<setw(8)<<"method"<<right<<setw(10)<<"initial"<<setw(10)<<"obtuses"
+        <<setw(10)<<"steiners"<<setw(10)<<"energy"<<setw(10)<<"sec"<<"  status"<<endl;
+    for (const Batch_entry& entry : entries) {
+        if (entry.status != "ok" && entry.status != "cached") failed++;
+        std_string name = std::filesystem::path(entry.file).filename().string();
+        summary<<name<<","<<entry.method<<","<<entry.init_obtuses<<","<<entry.final_obtuses<<","<<entry.num_steiners<<","
+               <<entry.energy<<","<<entry.seconds<<","<<entry.coordinate_bits.mean()<<","<<entry.coordinate_bits.max<<","
+               <<entry.status<<endl;
+        cout<<left<<setw(48)<<name<<setw(8)<<entry.method<<right<<setw(10)<<entry.init_obtuses<<setw(10)<<entry.final_obtuses
+            <<setw(10)<<entry.num_steiners<<fixed<<setprecision(2)<<setw(10)<<entry.energy<<setw(10)<<entry.seconds
+            <<"  "<<entry.status<<endl;
+        cout.unsetf(ios::fixed);
+    }
+    cout<<files.size() - failed<<" of "<<files.size()<<" instances solved, solutions in "<<output_dir<<endl;
+    return failed;
+}
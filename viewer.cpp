@@ -0,0 +1,71 @@
+#include "includes/utils/solver.h"
+#include "includes/utils/extra_graphics.h"
+
+using namespace boost::json;
+using namespace std;
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using CDT = CGAL::Constrained_Delaunay_triangulation_2<K>;
+using Point = CDT::Point;
+using Custom_CDT = Custom_Constrained_Delaunay_triangulation_2<K>;
+using Point_2 = K::Point_2;
+using Vertex_handle = Custom_CDT::Vertex_handle;
+namespace bj = boost::json;
+using boost_string = bj::string;
+using std_string = std::string;
+
+//The solver with a window of the final triangulation (built only with Qt)
+int main(int argc, char** argv) {
+    value jv;
+    std_string input_path, output_path;
+    Solve_options options;
+    if (!parse_arguments(argc, argv, input_path, output_path, options)) return 1;
+    set_run_time_limit(options.total_time_limit);
+    install_stop_signals();
+
+    read_json(input_path, jv);
+    Solve_result result;
+    if (!solve_instance(jv, options, result)) return 1;
+    Custom_CDT& simulated_cdt = result.cdt;
+    Polygon& polygon = result.polygon;
+    const vector<Point_2>& points = result.points;
+
+    //CGAL::draw(simulated_cdt);
+    //print_polygon_edges(simulated_polygon);
+    
+    double min_x = std::numeric_limits<double>::max();
+    double max_x = std::numeric_limits<double>::lowest();
+    double min_y = std::numeric_limits<double>::max();
+    double max_y = std::numeric_limits<double>::lowest();
+
+    // Calculate min and max for both x and y coordinates
+    for (const auto& point : points) {
+        double x = CGAL::to_double(point.x());
+        double y = CGAL::to_double(point.y());
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+    }
+
+    QApplication app(argc, argv);
+    CDTGraphicsView view(simulated_cdt, polygon);
+    view.setRenderHint(QPainter::Antialiasing);
+    view.setWindowTitle("Delaunay Triangulation with Point Coordinates");
+    view.resize(1000, 1000);
+    //Center and zoom the view
+    view.fitInView(view.scene()->sceneRect(), Qt::KeepAspectRatio);
+    double scaleFactor = 1.5;
+    view.scale(scaleFactor, scaleFactor);
+
+    //double centerY = (min_y + max_y) / 2; //Calculate the center y position based on the points
+    double centerX = (min_x + max_x) / 2;
+    double centerY = (min_y + max_y) / 2;
+    //view.verticalScrollBar()->setValue(centerY);
+    
+    view.translate(-centerX * scaleFactor + view.width() / 2, -centerY * scaleFactor + view.height() / 2);
+    view.show();
+    //////////// PHASE 3: JSON FILE OUTPUT //////////////////////////////
+
+    output(jv, simulated_cdt, points, result.final_obtuses, output_path, result.randomization);
+    return app.exec();
+}